@@ -28,9 +28,17 @@ def generate_heat_data(nx=500, ny=500):
     
     return temperature
 
-# Generate data
-print("Generating simulated heat equation data...")
-data = generate_heat_data()
+# Solve in-process when the heat module is built (make python); otherwise
+# fall back to the analytic approximation
+try:
+    import heat
+    print("Solving heat equation in-process...")
+    solver = heat.Solver(500, 500)
+    solver.solve(1000, 1e-6)
+    data = np.asarray(solver).T
+except ImportError:
+    print("Generating simulated heat equation data...")
+    data = generate_heat_data()
 
 # Create visualization
 print("Creating visualizations...")
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+
+#define N_DEFAULT 128       // Global grid points per dimension
+#define MAX_ITER 1000
+#define TOLERANCE 1e-6
+#define BOUNDARY_TEMP 100.0
+#define BLOCK_J 16          // Rows per cache block in the 2.5D sweep
+
+// 3D heat equation solver: 7-point Jacobi stencil, 3D Cartesian domain
+// decomposition with face halos exchanged through MPI subarray datatypes,
+// and 2.5D cache blocking (the sweep streams through the outermost
+// dimension, keeping a rolling window of three planes of one j-block in cache).
+//
+//   mpirun -np P ./heat_3d [N] [output.vtk]
+
+typedef struct {
+    int n[3];               // Owned interior points per dimension
+    int start[3];           // Global index of the first owned point
+    int dim[3];             // Local extents including ghosts (n + 2)
+    MPI_Comm cart;
+    int nbr_lo[3], nbr_hi[3];
+    MPI_Datatype face_send_lo[3], face_send_hi[3];
+    MPI_Datatype face_recv_lo[3], face_recv_hi[3];
+} domain_t;
+
+#define IDX(d, i, j, k) ((((size_t)(i)) * (d)->dim[1] + (j)) * (d)->dim[2] + (k))
+
+// One face of the local box as a subarray type: layer `at` of dimension `axis`
+static MPI_Datatype face_type(const domain_t *d, int axis, int at) {
+    MPI_Datatype t;
+    int sub[3], start[3];
+    for (int a = 0; a < 3; a++) {
+        sub[a] = d->n[a];
+        start[a] = 1;
+    }
+    sub[axis] = 1;
+    start[axis] = at;
+    MPI_Type_create_subarray(3, d->dim, sub, start, MPI_ORDER_C, MPI_DOUBLE, &t);
+    MPI_Type_commit(&t);
+    return t;
+}
+
+static void setup_domain(domain_t *d, int n_global) {
+    int size, rank, dims[3] = {0, 0, 0}, periods[3] = {0, 0, 0}, coords[3];
+
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Dims_create(size, 3, dims);
+    MPI_Cart_create(MPI_COMM_WORLD, 3, dims, periods, 1, &d->cart);
+    MPI_Comm_rank(d->cart, &rank);
+    MPI_Cart_coords(d->cart, rank, 3, coords);
+
+    // Split the interior points 1..N-2 of each dimension
+    for (int a = 0; a < 3; a++) {
+        int interior = n_global - 2;
+        int base = interior / dims[a], extra = interior % dims[a];
+        d->n[a] = base + (coords[a] < extra);
+        d->start[a] = 1 + coords[a] * base + (coords[a] < extra ? coords[a] : extra);
+        d->dim[a] = d->n[a] + 2;
+        MPI_Cart_shift(d->cart, a, 1, &d->nbr_lo[a], &d->nbr_hi[a]);
+    }
+    for (int a = 0; a < 3; a++) {
+        d->face_send_lo[a] = face_type(d, a, 1);
+        d->face_send_hi[a] = face_type(d, a, d->n[a]);
+        d->face_recv_lo[a] = face_type(d, a, 0);
+        d->face_recv_hi[a] = face_type(d, a, d->n[a] + 1);
+    }
+}
+
+// Exchange the six face halos (edges and corners are not needed by the 7-point stencil)
+static void exchange_halo(const domain_t *d, double *u) {
+    for (int a = 0; a < 3; a++) {
+        MPI_Sendrecv(u, 1, d->face_send_lo[a], d->nbr_lo[a], 2 * a,
+                     u, 1, d->face_recv_hi[a], d->nbr_hi[a], 2 * a,
+                     d->cart, MPI_STATUS_IGNORE);
+        MPI_Sendrecv(u, 1, d->face_send_hi[a], d->nbr_hi[a], 2 * a + 1,
+                     u, 1, d->face_recv_lo[a], d->nbr_lo[a], 2 * a + 1,
+                     d->cart, MPI_STATUS_IGNORE);
+    }
+}
+
+// 2.5D blocked Jacobi sweep. Each thread takes blocks of BLOCK_J rows and
+// streams through i, so planes i-1, i, i+1 of the block stay in cache.
+// The 7-point kernel is its own: heat_stencil.h only handles 2D row tables.
+static double sweep(const domain_t *d, const double *u, double *u_new) {
+    const int ni = d->n[0], nj = d->n[1], nk = d->n[2];
+    const size_t si = (size_t)d->dim[1] * d->dim[2], sj = d->dim[2];
+    int nblocks = (nj + BLOCK_J - 1) / BLOCK_J;
+    double max_diff = 0.0;
+
+    #pragma omp parallel for reduction(max:max_diff) schedule(static)
+    for (int b = 0; b < nblocks; b++) {
+        int j0 = 1 + b * BLOCK_J;
+        int j1 = (j0 + BLOCK_J <= nj + 1) ? j0 + BLOCK_J : nj + 1;
+        for (int i = 1; i <= ni; i++) {
+            for (int j = j0; j < j1; j++) {
+                const double *c = &u[IDX(d, i, j, 0)];
+                double *out = &u_new[IDX(d, i, j, 0)];
+                #pragma omp simd reduction(max:max_diff)
+                for (int k = 1; k <= nk; k++) {
+                    double v = (c[k - si] + c[k + si] + c[k - sj] + c[k + sj]
+                                + c[k - 1] + c[k + 1]) * (1.0 / 6.0);
+                    double diff = fabs(v - c[k]);
+                    out[k] = v;
+                    max_diff = (diff > max_diff) ? diff : max_diff;
+                }
+            }
+        }
+    }
+    return max_diff;
+}
+
+// Write the global field as a legacy VTK structured-points file (binary,
+// big-endian floats) with collective MPI-IO; every rank writes its own box.
+static void write_vtk_3d(const char *filename, const domain_t *d, const double *u, int n_global) {
+    char header[512];
+    int lo[3], cnt[3], rank;
+    MPI_File fh;
+    MPI_Datatype filetype;
+    const union { int i; char c; } probe = { 1 };
+
+    MPI_Comm_rank(d->cart, &rank);
+    int hlen = snprintf(header, sizeof(header),
+        "# vtk DataFile Version 2.0\n3D Heat Equation Data\nBINARY\n"
+        "DATASET STRUCTURED_POINTS\nDIMENSIONS %d %d %d\nORIGIN 0 0 0\nSPACING 1 1 1\n"
+        "POINT_DATA %ld\nSCALARS temperature float 1\nLOOKUP_TABLE default\n",
+        n_global, n_global, n_global, (long)n_global * n_global * n_global);
+
+    // Owned box, widened by the global boundary layer on edge ranks
+    for (int a = 0; a < 3; a++) {
+        lo[a] = (d->start[a] == 1) ? 0 : 1;
+        int hi = (d->start[a] + d->n[a] == n_global - 1) ? d->n[a] + 1 : d->n[a];
+        cnt[a] = hi - lo[a] + 1;
+    }
+
+    // VTK wants x fastest: file array is [k][j][i] with x = i
+    size_t count = (size_t)cnt[0] * cnt[1] * cnt[2], p = 0;
+    float *buf = (float *)malloc(count * sizeof(float));
+    for (int k = lo[2]; k < lo[2] + cnt[2]; k++) {
+        for (int j = lo[1]; j < lo[1] + cnt[1]; j++) {
+            for (int i = lo[0]; i < lo[0] + cnt[0]; i++) {
+                float v = (float)u[IDX(d, i, j, k)];
+                if (probe.c) {
+                    unsigned char *s = (unsigned char *)&v, t;
+                    t = s[0]; s[0] = s[3]; s[3] = t;
+                    t = s[1]; s[1] = s[2]; s[2] = t;
+                }
+                buf[p++] = v;
+            }
+        }
+    }
+
+    int gsizes[3] = { n_global, n_global, n_global };
+    int subsizes[3] = { cnt[2], cnt[1], cnt[0] };
+    int starts[3] = { d->start[2] - 1 + lo[2], d->start[1] - 1 + lo[1], d->start[0] - 1 + lo[0] };
+    MPI_Type_create_subarray(3, gsizes, subsizes, starts, MPI_ORDER_C, MPI_FLOAT, &filetype);
+    MPI_Type_commit(&filetype);
+
+    if (MPI_File_open(d->cart, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                      MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: Could not open file %s\n", filename);
+        }
+        free(buf);
+        MPI_Type_free(&filetype);
+        return;
+    }
+    MPI_File_set_size(fh, 0);
+    if (rank == 0) {
+        MPI_File_write_at(fh, 0, header, hlen, MPI_CHAR, MPI_STATUS_IGNORE);
+    }
+    MPI_File_set_view(fh, hlen, MPI_FLOAT, filetype, "native", MPI_INFO_NULL);
+    MPI_File_write_all(fh, buf, (int)count, MPI_FLOAT, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+
+    if (rank == 0) {
+        printf("VTK file written to: %s\n", filename);
+    }
+    free(buf);
+    MPI_Type_free(&filetype);
+}
+
+int main(int argc, char **argv) {
+    domain_t d;
+    double *u, *u_new, *tmp;
+    int iter, rank, size, n_global;
+    double max_diff, global_max_diff;
+    double start_time, end_time;
+
+    // Initialize MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    n_global = (argc > 1) ? atoi(argv[1]) : N_DEFAULT;
+    setup_domain(&d, n_global);
+    MPI_Comm_rank(d.cart, &rank);
+
+    size_t total = (size_t)d.dim[0] * d.dim[1] * d.dim[2];
+    u = (double *)malloc(total * sizeof(double));
+    u_new = (double *)malloc(total * sizeof(double));
+
+    // Initialize both buffers: zero inside, boundary temperature on global faces
+    #pragma omp parallel for
+    for (int i = 0; i < d.dim[0]; i++) {
+        for (int j = 0; j < d.dim[1]; j++) {
+            for (int k = 0; k < d.dim[2]; k++) {
+                int gi = d.start[0] + i - 1, gj = d.start[1] + j - 1, gk = d.start[2] + k - 1;
+                double value = 0.0;
+                if (gi == 0 || gi == n_global - 1 || gj == 0 || gj == n_global - 1 ||
+                    gk == 0 || gk == n_global - 1) {
+                    value = BOUNDARY_TEMP;
+                }
+                u[IDX(&d, i, j, k)] = value;
+                u_new[IDX(&d, i, j, k)] = value;
+            }
+        }
+    }
+
+    if (rank == 0) {
+        int dims[3], periods[3], coords[3];
+        MPI_Cart_get(d.cart, 3, dims, periods, coords);
+        printf("3D Heat Equation Solver - Hybrid MPI+OpenMP\n");
+        printf("Grid size: %d x %d x %d, process grid: %d x %d x %d, threads per process: %d\n",
+               n_global, n_global, n_global, dims[0], dims[1], dims[2], omp_get_max_threads());
+    }
+
+    // Start timing
+    start_time = MPI_Wtime();
+
+    // Iterative solver
+    for (iter = 0; iter < MAX_ITER; iter++) {
+        exchange_halo(&d, u);
+        max_diff = sweep(&d, u, u_new);
+        tmp = u;
+        u = u_new;
+        u_new = tmp;
+
+        // Global reduction to find maximum difference
+        MPI_Allreduce(&max_diff, &global_max_diff, 1, MPI_DOUBLE, MPI_MAX, d.cart);
+        if (global_max_diff < TOLERANCE) {
+            if (rank == 0) {
+                printf("Converged after %d iterations.\n", iter);
+            }
+            break;
+        }
+    }
+
+    // End timing
+    end_time = MPI_Wtime();
+    if (rank == 0) {
+        double updates = (double)(n_global - 2) * (n_global - 2) * (n_global - 2)
+                         * ((iter < MAX_ITER) ? iter + 1 : MAX_ITER);
+        printf("3D parallel execution time: %f seconds (%.2f Mupdates/s)\n",
+               end_time - start_time, updates / (end_time - start_time) / 1e6);
+    }
+
+    if (argc > 2) {
+        write_vtk_3d(argv[2], &d, u, n_global);
+    }
+
+    // Free memory
+    for (int a = 0; a < 3; a++) {
+        MPI_Type_free(&d.face_send_lo[a]);
+        MPI_Type_free(&d.face_send_hi[a]);
+        MPI_Type_free(&d.face_recv_lo[a]);
+        MPI_Type_free(&d.face_recv_hi[a]);
+    }
+    MPI_Comm_free(&d.cart);
+    free(u);
+    free(u_new);
+
+    MPI_Finalize();
+    return 0;
+}
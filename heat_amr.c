@@ -0,0 +1,786 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+#include "heat_config.h"
+
+#define MAX_ITER 20000       // BiCGSTAB iterations per cycle
+#define TOLERANCE 1e-6
+
+// Patch size (cells per side, power of two) and quadtree depth. Level L has
+// PATCH << L cells per side; the mesh starts uniform at BASE_LEVEL.
+#define PATCH 16
+#define BASE_LEVEL 2
+#define MAX_LEVEL 6
+#define MAX_CYCLES 8
+
+// Refine a patch when the temperature jump between neighbouring cells
+// exceeds REFINE_TOL; coarsen four siblings when all stay below COARSEN_TOL
+#define REFINE_TOL 1.0
+#define COARSEN_TOL (REFINE_TOL / 4)
+
+// Gaussian heat source on the unit square
+#define SRC_X 0.35
+#define SRC_Y 0.6
+#define SRC_SIGMA 0.02
+#define SRC_STRENGTH 2e5
+
+#define STRIDE (PATCH + 2)
+#define PATCH_CELLS (STRIDE * STRIDE)
+
+// Block-structured AMR solver for -(u_xx + u_yy) = f on the unit square.
+//
+//   mpirun -np P ./heat_amr [config]
+//
+// The mesh is a quadtree of PATCH x PATCH cell-centred patches, each with one
+// ghost layer, and the same 5-point Jacobi kernel runs on every patch. Neighbour
+// levels differ by at most one (2:1 balance). Ghosts are filled by copy from a
+// same-level neighbour, by averaging 2x2 cells of a finer neighbour, or by
+// linear interpolation between a coarser neighbour and the patch interior.
+// Each solve accelerates the Jacobi sweep with BiCGSTAB; the program exits
+// non-zero if the last cycle does not converge.
+//
+// Every rank holds the tree metadata; patch data lives only on the owner.
+// Leaves are split among ranks in Morton order and among threads within a
+// rank. After each solve cycle the mesh is regridded from gradient estimates
+// and the new patches start from the interpolated solution.
+
+typedef struct {
+    int level, pi, pj;          // Patch index at its level
+    int parent, child[4];       // child[0] < 0 for leaves; child = 2 * di + dj
+    int alive, owner;
+    double *u, *u_new, *f;      // STRIDE x STRIDE; remote copies only have u
+    int *ghost_leaf;            // Leaf behind each face ghost (-1: domain edge)
+} patch_t;
+
+typedef struct {
+    patch_t *p;
+    int n, cap;
+    int *leaves, nleaves;       // Morton order
+    int lo, hi;                 // This rank's slice of leaves
+} tree_t;
+
+typedef struct {
+    int *send_count, *recv_count, *send_displ, *recv_displ;
+    int *send_ids, *recv_ids;
+    double *send_buf, *recv_buf;
+    MPI_Request *req;
+} exchange_t;
+
+static int rank, size;
+static heat_config_t cfg;
+
+static int new_node(tree_t *t, int level, int pi, int pj, int parent) {
+    if (t->n == t->cap) {
+        t->cap = t->cap ? 2 * t->cap : 256;
+        t->p = (patch_t *)realloc(t->p, t->cap * sizeof(patch_t));
+    }
+    patch_t *q = &t->p[t->n];
+    memset(q, 0, sizeof(*q));
+    q->level = level;
+    q->pi = pi;
+    q->pj = pj;
+    q->parent = parent;
+    q->child[0] = -1;
+    q->alive = 1;
+    return t->n++;
+}
+
+// Create the four children of leaf n (metadata only)
+static void split(tree_t *t, int n) {
+    for (int c = 0; c < 4; c++) {
+        int k = new_node(t, t->p[n].level + 1, 2 * t->p[n].pi + c / 2, 2 * t->p[n].pj + c % 2, n);
+        t->p[k].owner = t->p[n].owner;
+        t->p[n].child[c] = k;
+    }
+}
+
+static double source_value(double x, double y) {
+    double r2 = (x - SRC_X) * (x - SRC_X) + (y - SRC_Y) * (y - SRC_Y);
+    return SRC_STRENGTH * exp(-r2 / (2.0 * SRC_SIGMA * SRC_SIGMA));
+}
+
+// Allocate data of an owned leaf; the source is stored pre-scaled by h^2
+static void alloc_leaf(tree_t *t, int n) {
+    patch_t *q = &t->p[n];
+    double h = 1.0 / (PATCH << q->level);
+    if (q->u == NULL) q->u = (double *)calloc(PATCH_CELLS, sizeof(double));
+    q->u_new = (double *)calloc(PATCH_CELLS, sizeof(double));
+    q->f = (double *)calloc(PATCH_CELLS, sizeof(double));
+    for (int a = 0; a < PATCH; a++) {
+        for (int b = 0; b < PATCH; b++) {
+            double x = (q->pi * PATCH + a + 0.5) * h;
+            double y = (q->pj * PATCH + b + 0.5) * h;
+            q->f[(a + 1) * STRIDE + b + 1] = h * h * source_value(x, y);
+        }
+    }
+}
+
+static void free_leaf(patch_t *q) {
+    free(q->u);
+    free(q->u_new);
+    free(q->f);
+    free(q->ghost_leaf);
+    q->u = q->u_new = q->f = NULL;
+    q->ghost_leaf = NULL;
+}
+
+// Value of interior cell (a, b) of patch q, 0-based
+static inline double cell(const patch_t *q, int a, int b) {
+    return q->u[(a + 1) * STRIDE + b + 1];
+}
+
+// Leaf containing the finest-level cell (fi, fj)
+static int find_leaf(const tree_t *t, int fi, int fj) {
+    int n = 0;
+    while (t->p[n].child[0] >= 0) {
+        int l = t->p[n].level + 1;
+        int ci = (fi >> (MAX_LEVEL - l)) / PATCH, cj = (fj >> (MAX_LEVEL - l)) / PATCH;
+        n = t->p[n].child[2 * (ci & 1) + (cj & 1)];
+    }
+    return n;
+}
+
+// Leaf holding level-L cell (gi, gj), or -1 outside the domain
+static int leaf_at(const tree_t *t, int level, int gi, int gj) {
+    int ncell = PATCH << level;
+    if (gi < 0 || gj < 0 || gi >= ncell || gj >= ncell) return -1;
+    return find_leaf(t, gi << (MAX_LEVEL - level), gj << (MAX_LEVEL - level));
+}
+
+// Value of the level-L ghost cell (gi, gj) held by leaf `src`, next to
+// interior value `inner`. `along_j` says whether the face runs along j
+// (north/south faces), `edge` which domain edge applies if src < 0.
+static double ghost_value(const tree_t *t, int src, int level, int gi, int gj, double inner,
+                          int along_j, int edge) {
+    if (src < 0) return 2.0 * cfg.value[edge] - inner;
+
+    const patch_t *q = &t->p[src];
+    int oi = q->pi * PATCH, oj = q->pj * PATCH;
+    if (q->level == level) {
+        return cell(q, gi - oi, gj - oj);
+    }
+    if (q->level == level + 1) {
+        int a = 2 * gi - oi, b = 2 * gj - oj;
+        return 0.25 * (cell(q, a, b) + cell(q, a + 1, b) + cell(q, a, b + 1) + cell(q, a + 1, b + 1));
+    }
+    // Coarser neighbour: interpolate along the face, then between the coarse
+    // cell centre and the interior cell
+    int a = (gi >> 1) - oi, b = (gj >> 1) - oj;
+    int t_idx = along_j ? b : a, t_fine = along_j ? gj : gi;
+    double c = cell(q, a, b), slope = 0.0;
+    double lo = (t_idx > 0) ? (along_j ? cell(q, a, b - 1) : cell(q, a - 1, b)) : c;
+    double hi = (t_idx < PATCH - 1) ? (along_j ? cell(q, a, b + 1) : cell(q, a + 1, b)) : c;
+    if (t_idx > 0 && t_idx < PATCH - 1) slope = 0.5 * (hi - lo);
+    else slope = (t_idx > 0) ? (c - lo) : (hi - c);
+    c += ((t_fine & 1) ? 0.25 : -0.25) * slope;
+    return (2.0 * c + inner) / 3.0;
+}
+
+// Look up the leaves behind the ghosts of leaf n, in the order fill_ghosts uses
+static void find_ghost_leaves(const tree_t *t, int n, int *out) {
+    const patch_t *q = &t->p[n];
+    int L = q->level, oi = q->pi * PATCH, oj = q->pj * PATCH;
+    for (int k = 0; k < PATCH; k++) {
+        out[4 * k] = leaf_at(t, L, oi - 1, oj + k);
+        out[4 * k + 1] = leaf_at(t, L, oi + PATCH, oj + k);
+        out[4 * k + 2] = leaf_at(t, L, oi + k, oj - 1);
+        out[4 * k + 3] = leaf_at(t, L, oi + k, oj + PATCH);
+    }
+}
+
+static void fill_ghosts(const tree_t *t, int n) {
+    const patch_t *q = &t->p[n];
+    const int *g = q->ghost_leaf;
+    double *u = q->u;
+    int L = q->level, oi = q->pi * PATCH, oj = q->pj * PATCH;
+    for (int k = 0; k < PATCH; k++) {
+        u[k + 1] = ghost_value(t, g[4 * k], L, oi - 1, oj + k, u[STRIDE + k + 1], 1, EDGE_NORTH);
+        u[(PATCH + 1) * STRIDE + k + 1] = ghost_value(t, g[4 * k + 1], L, oi + PATCH, oj + k,
+                                                      u[PATCH * STRIDE + k + 1], 1, EDGE_SOUTH);
+        u[(k + 1) * STRIDE] = ghost_value(t, g[4 * k + 2], L, oi + k, oj - 1,
+                                          u[(k + 1) * STRIDE + 1], 0, EDGE_WEST);
+        u[(k + 1) * STRIDE + PATCH + 1] = ghost_value(t, g[4 * k + 3], L, oi + k, oj + PATCH,
+                                                      u[(k + 1) * STRIDE + PATCH], 0, EDGE_EAST);
+    }
+}
+
+// Distinct leaves across the four faces of leaf n; returns the count
+static int face_neighbours(const tree_t *t, int n, int *out) {
+    int cand[4 * PATCH], count = 0;
+    find_ghost_leaves(t, n, cand);
+    for (int c = 0; c < 4 * PATCH; c++) {
+        int seen = (cand[c] < 0);
+        for (int s = 0; s < count && !seen; s++) seen = (out[s] == cand[c]);
+        if (!seen) out[count++] = cand[c];
+    }
+    return count;
+}
+
+static void collect(tree_t *t, int n) {
+    if (t->p[n].child[0] < 0) {
+        t->leaves[t->nleaves++] = n;
+        return;
+    }
+    for (int c = 0; c < 4; c++) collect(t, t->p[n].child[c]);
+}
+
+// Rebuild the Morton-ordered leaf list and this rank's even slice of it
+static void order_leaves(tree_t *t) {
+    free(t->leaves);
+    t->leaves = (int *)malloc(t->n * sizeof(int));
+    t->nleaves = 0;
+    collect(t, 0);
+    t->lo = (int)((long)rank * t->nleaves / size);
+    t->hi = (int)((long)(rank + 1) * t->nleaves / size);
+}
+
+// Move leaf data to new owners. Both sides walk nodes in ascending order, so
+// one tag is enough.
+static void migrate(tree_t *t, const int *new_owner) {
+    MPI_Request *req = (MPI_Request *)malloc(t->n * sizeof(MPI_Request));
+    int nreq = 0;
+    for (int n = 0; n < t->n; n++) {
+        patch_t *q = &t->p[n];
+        if (!q->alive || q->child[0] >= 0 || q->owner == new_owner[n]) continue;
+        if (q->owner == rank) {
+            MPI_Isend(q->u, PATCH_CELLS, MPI_DOUBLE, new_owner[n], 0, MPI_COMM_WORLD, &req[nreq++]);
+        } else if (new_owner[n] == rank) {
+            q->u = (double *)malloc(PATCH_CELLS * sizeof(double));
+            MPI_Irecv(q->u, PATCH_CELLS, MPI_DOUBLE, q->owner, 0, MPI_COMM_WORLD, &req[nreq++]);
+        }
+    }
+    MPI_Waitall(nreq, req, MPI_STATUSES_IGNORE);
+    for (int n = 0; n < t->n; n++) {
+        patch_t *q = &t->p[n];
+        if (!q->alive || q->child[0] >= 0 || q->owner == new_owner[n]) continue;
+        if (q->owner == rank) {
+            free_leaf(q);
+        } else if (new_owner[n] == rank) {
+            alloc_leaf(t, n);
+        }
+        q->owner = new_owner[n];
+    }
+    free(req);
+}
+
+static void exchange_free(exchange_t *ex) {
+    free(ex->send_count); free(ex->recv_count);
+    free(ex->send_displ); free(ex->recv_displ);
+    free(ex->send_ids); free(ex->recv_ids);
+    free(ex->send_buf); free(ex->recv_buf);
+    free(ex->req);
+    memset(ex, 0, sizeof(*ex));
+}
+
+// Cache the ghost sources of the local leaves, find the remote leaves they
+// read and tell their owners
+static void exchange_build(tree_t *t, exchange_t *ex) {
+    char *needed = (char *)calloc(t->n, 1);
+    int *nbr = (int *)malloc(4 * PATCH * sizeof(int));
+    exchange_free(ex);
+    ex->send_count = (int *)calloc(size, sizeof(int));
+    ex->recv_count = (int *)calloc(size, sizeof(int));
+    ex->send_displ = (int *)calloc(size + 1, sizeof(int));
+    ex->recv_displ = (int *)calloc(size + 1, sizeof(int));
+    ex->req = (MPI_Request *)malloc(2 * size * sizeof(MPI_Request));
+
+    for (int k = t->lo; k < t->hi; k++) {
+        patch_t *q = &t->p[t->leaves[k]];
+        free(q->ghost_leaf);
+        q->ghost_leaf = (int *)malloc(4 * PATCH * sizeof(int));
+        find_ghost_leaves(t, t->leaves[k], q->ghost_leaf);
+        int cnt = face_neighbours(t, t->leaves[k], nbr);
+        for (int c = 0; c < cnt; c++) {
+            if (t->p[nbr[c]].owner != rank) needed[nbr[c]] = 1;
+        }
+    }
+    for (int n = 0; n < t->n; n++) {
+        if (needed[n]) ex->recv_count[t->p[n].owner]++;
+    }
+    for (int r = 0; r < size; r++) ex->recv_displ[r + 1] = ex->recv_displ[r] + ex->recv_count[r];
+    ex->recv_ids = (int *)malloc((ex->recv_displ[size] + 1) * sizeof(int));
+    int *fill = (int *)calloc(size, sizeof(int));
+    for (int n = 0; n < t->n; n++) {
+        if (!needed[n]) continue;
+        patch_t *q = &t->p[n];
+        ex->recv_ids[ex->recv_displ[q->owner] + fill[q->owner]++] = n;
+        q->u = (double *)calloc(PATCH_CELLS, sizeof(double));
+    }
+
+    MPI_Alltoall(ex->recv_count, 1, MPI_INT, ex->send_count, 1, MPI_INT, MPI_COMM_WORLD);
+    for (int r = 0; r < size; r++) ex->send_displ[r + 1] = ex->send_displ[r] + ex->send_count[r];
+    ex->send_ids = (int *)malloc((ex->send_displ[size] + 1) * sizeof(int));
+    MPI_Alltoallv(ex->recv_ids, ex->recv_count, ex->recv_displ, MPI_INT,
+                  ex->send_ids, ex->send_count, ex->send_displ, MPI_INT, MPI_COMM_WORLD);
+    ex->send_buf = (double *)malloc(((size_t)ex->send_displ[size] + 1) * PATCH * PATCH * sizeof(double));
+    ex->recv_buf = (double *)malloc(((size_t)ex->recv_displ[size] + 1) * PATCH * PATCH * sizeof(double));
+    free(fill);
+    free(nbr);
+    free(needed);
+}
+
+// Refresh the interiors of remote copies from their owners
+static void exchange_run(tree_t *t, exchange_t *ex) {
+    const int pc = PATCH * PATCH;
+    int nreq = 0;
+    for (int r = 0; r < size; r++) {
+        if (ex->recv_count[r] > 0) {
+            MPI_Irecv(ex->recv_buf + (size_t)ex->recv_displ[r] * pc, ex->recv_count[r] * pc,
+                      MPI_DOUBLE, r, 1, MPI_COMM_WORLD, &ex->req[nreq++]);
+        }
+    }
+    for (int k = 0; k < ex->send_displ[size]; k++) {
+        const patch_t *q = &t->p[ex->send_ids[k]];
+        for (int a = 0; a < PATCH; a++) {
+            memcpy(ex->send_buf + (size_t)k * pc + a * PATCH, q->u + (a + 1) * STRIDE + 1,
+                   PATCH * sizeof(double));
+        }
+    }
+    for (int r = 0; r < size; r++) {
+        if (ex->send_count[r] > 0) {
+            MPI_Isend(ex->send_buf + (size_t)ex->send_displ[r] * pc, ex->send_count[r] * pc,
+                      MPI_DOUBLE, r, 1, MPI_COMM_WORLD, &ex->req[nreq++]);
+        }
+    }
+    MPI_Waitall(nreq, ex->req, MPI_STATUSES_IGNORE);
+    for (int k = 0; k < ex->recv_displ[size]; k++) {
+        patch_t *q = &t->p[ex->recv_ids[k]];
+        for (int a = 0; a < PATCH; a++) {
+            memcpy(q->u + (a + 1) * STRIDE + 1, ex->recv_buf + (size_t)k * pc + a * PATCH,
+                   PATCH * sizeof(double));
+        }
+    }
+}
+
+static void drop_remote_copies(tree_t *t) {
+    for (int n = 0; n < t->n; n++) {
+        patch_t *q = &t->p[n];
+        if (q->alive && q->child[0] < 0 && q->owner != rank && q->u != NULL) {
+            free(q->u);
+            q->u = NULL;
+        }
+    }
+}
+
+// Work vectors of the local leaves for the Krylov solve, each STRIDE x STRIDE
+// with its own ghost layer so that it can stand in for q->u in a sweep
+enum { V_X, V_R, V_RHAT, V_P, V_V, V_S, V_T, V_B, NVEC };
+
+static inline double *vec(const tree_t *t, double *work, int v, int k) {
+    return work + ((size_t)(k - t->lo) * NVEC + v) * PATCH_CELLS;
+}
+
+// One Jacobi sweep G over the local leaves: vector vout = G(vector vin).
+// The leaves' u pointers are aimed at vin for the ghost exchange and fill.
+static void jacobi_apply(tree_t *t, exchange_t *ex, double *work, double **saved, int vin, int vout) {
+    int k;
+    for (k = t->lo; k < t->hi; k++) {
+        patch_t *q = &t->p[t->leaves[k]];
+        saved[k - t->lo] = q->u;
+        q->u = vec(t, work, vin, k);
+    }
+    exchange_run(t, ex);
+    #pragma omp parallel for schedule(static)
+    for (k = t->lo; k < t->hi; k++) {
+        fill_ghosts(t, t->leaves[k]);
+    }
+    #pragma omp parallel for schedule(static)
+    for (k = t->lo; k < t->hi; k++) {
+        patch_t *q = &t->p[t->leaves[k]];
+        double *out = vec(t, work, vout, k);
+        double *rows[STRIDE], *new_rows[STRIDE];
+        for (int a = 0; a < STRIDE; a++) {
+            rows[a] = q->u + a * STRIDE;
+            new_rows[a] = out + a * STRIDE;
+        }
+        heat_sweep_block(rows, new_rows, q->f, STRIDE, 1, PATCH + 1, 1, PATCH + 1);
+        q->u = saved[k - t->lo];
+    }
+}
+
+// Vector dst = a * x + b * y + c * z on the interiors; returns the local max |dst|
+static double combine(const tree_t *t, double *work, int dst, double a, int x, double b, int y,
+                      double c, int z) {
+    double m = 0.0;
+    int k;
+    #pragma omp parallel for schedule(static) reduction(max:m)
+    for (k = t->lo; k < t->hi; k++) {
+        double *d = vec(t, work, dst, k);
+        const double *xv = vec(t, work, x, k), *yv = vec(t, work, y, k), *zv = vec(t, work, z, k);
+        for (int i = 1; i <= PATCH; i++) {
+            for (int j = i * STRIDE + 1; j <= i * STRIDE + PATCH; j++) {
+                d[j] = a * xv[j] + b * yv[j] + c * zv[j];
+                m = fmax(m, fabs(d[j]));
+            }
+        }
+    }
+    return m;
+}
+
+static double dot(const tree_t *t, double *work, int x, int y) {
+    double s = 0.0, global_s;
+    int k;
+    #pragma omp parallel for schedule(static) reduction(+:s)
+    for (k = t->lo; k < t->hi; k++) {
+        const double *xv = vec(t, work, x, k), *yv = vec(t, work, y, k);
+        for (int i = 1; i <= PATCH; i++) {
+            for (int j = i * STRIDE + 1; j <= i * STRIDE + PATCH; j++) {
+                s += xv[j] * yv[j];
+            }
+        }
+    }
+    MPI_Allreduce(&s, &global_s, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    return global_s;
+}
+
+static double global_max(double m) {
+    double global_m;
+    MPI_Allreduce(&m, &global_m, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return global_m;
+}
+
+// Solve the composite system on the current mesh. Plain Jacobi needs O(n^2)
+// sweeps on an n-cell-wide level, which after a few refinements is far more
+// than MAX_ITER, so the sweep is accelerated with BiCGSTAB: the fixed point
+// u = G(u) is the linear system (I - M) u = G(0), whose operator costs one
+// sweep. The residual G(u) - u is the change a Jacobi sweep would make, so
+// TOLERANCE means what it does for the other solvers. Returns the BiCGSTAB
+// iterations (two sweeps each) and the final max residual in *res.
+static int solve(tree_t *t, exchange_t *ex, double *res) {
+    int nloc = t->hi - t->lo, iter = 0, k;
+    double *work = (double *)calloc((size_t)nloc * NVEC * PATCH_CELLS, sizeof(double));
+    double **saved = (double **)malloc((nloc + 1) * sizeof(double *));
+    double rmax;
+
+    for (k = t->lo; k < t->hi; k++) {
+        memcpy(vec(t, work, V_X, k), t->p[t->leaves[k]].u, PATCH_CELLS * sizeof(double));
+    }
+    jacobi_apply(t, ex, work, saved, V_P, V_B);          // P is still zero
+    jacobi_apply(t, ex, work, saved, V_X, V_T);
+    rmax = global_max(combine(t, work, V_R, 1.0, V_T, -1.0, V_X, 0.0, V_X));
+
+    // Restart from the true residual after a breakdown or when the recursive
+    // residual claims convergence
+    while (rmax >= TOLERANCE && iter < MAX_ITER) {
+        double rho = 1.0, alpha = 1.0, omega = 1.0;
+        combine(t, work, V_RHAT, 1.0, V_R, 0.0, V_R, 0.0, V_R);
+        combine(t, work, V_P, 0.0, V_P, 0.0, V_P, 0.0, V_P);
+        combine(t, work, V_V, 0.0, V_V, 0.0, V_V, 0.0, V_V);
+        while (iter < MAX_ITER) {
+            double rho_new = dot(t, work, V_RHAT, V_R);
+            if (rho_new == 0.0 || omega == 0.0) break;
+            double beta = (rho_new / rho) * (alpha / omega);
+            rho = rho_new;
+            combine(t, work, V_P, 1.0, V_R, beta, V_P, -beta * omega, V_V);
+            jacobi_apply(t, ex, work, saved, V_P, V_V);
+            combine(t, work, V_V, 1.0, V_P, -1.0, V_V, 1.0, V_B);
+            double rv = dot(t, work, V_RHAT, V_V);
+            if (rv == 0.0) break;
+            alpha = rho / rv;
+            combine(t, work, V_S, 1.0, V_R, -alpha, V_V, 0.0, V_V);
+            jacobi_apply(t, ex, work, saved, V_S, V_T);
+            combine(t, work, V_T, 1.0, V_S, -1.0, V_T, 1.0, V_B);
+            double tt = dot(t, work, V_T, V_T);
+            omega = (tt > 0.0) ? dot(t, work, V_T, V_S) / tt : 0.0;
+            combine(t, work, V_X, 1.0, V_X, alpha, V_P, omega, V_S);
+            rmax = global_max(combine(t, work, V_R, 1.0, V_S, -omega, V_T, 0.0, V_T));
+            iter++;
+            if (rmax < TOLERANCE) break;
+        }
+        jacobi_apply(t, ex, work, saved, V_X, V_T);
+        rmax = global_max(combine(t, work, V_R, 1.0, V_T, -1.0, V_X, 0.0, V_X));
+    }
+
+    for (k = t->lo; k < t->hi; k++) {
+        memcpy(t->p[t->leaves[k]].u, vec(t, work, V_X, k), PATCH_CELLS * sizeof(double));
+    }
+    free(saved);
+    free(work);
+    *res = rmax;
+    return iter;
+}
+
+// Largest jump between neighbouring cells of a leaf, ghosts included
+static double jump_indicator(const patch_t *q) {
+    double m = 0.0;
+    for (int a = 0; a <= PATCH; a++) {
+        for (int b = 1; b <= PATCH; b++) {
+            m = fmax(m, fabs(q->u[(a + 1) * STRIDE + b] - q->u[a * STRIDE + b]));
+            m = fmax(m, fabs(q->u[b * STRIDE + a + 1] - q->u[b * STRIDE + a]));
+        }
+    }
+    return m;
+}
+
+// Adapt the mesh to the current solution; returns the number of patches changed
+static int regrid(tree_t *t, exchange_t *ex) {
+    int nl = t->nleaves, changes = 0;
+    int *flag = (int *)malloc(nl * sizeof(int));
+    int *counts = (int *)malloc(size * sizeof(int));
+    int *displs = (int *)malloc(size * sizeof(int));
+    int *nbr = (int *)malloc(4 * PATCH * sizeof(int));
+
+    // Gradient estimates of the local leaves (ghosts must be current)
+    exchange_run(t, ex);
+    int k;
+    #pragma omp parallel for schedule(static)
+    for (k = t->lo; k < t->hi; k++) {
+        const patch_t *q = &t->p[t->leaves[k]];
+        fill_ghosts(t, t->leaves[k]);
+        double m = jump_indicator(q);
+        flag[k] = (m > REFINE_TOL) ? 1 : (m < COARSEN_TOL) ? -1 : 0;
+    }
+    for (int r = 0; r < size; r++) {
+        displs[r] = (int)((long)r * nl / size);
+        counts[r] = (int)((long)(r + 1) * nl / size) - displs[r];
+    }
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_INT, flag, counts, displs, MPI_INT, MPI_COMM_WORLD);
+
+    // Every rank now makes the same decisions on its copy of the tree
+    int nn = t->n;
+    char *refine = (char *)calloc(nn, 1), *coarsen = (char *)calloc(nn, 1);
+    int *leaf_flag = (int *)calloc(nn, sizeof(int));
+    for (int i = 0; i < nl; i++) {
+        int n = t->leaves[i];
+        leaf_flag[n] = flag[i];
+        if (flag[i] > 0 && t->p[n].level < MAX_LEVEL) refine[n] = 1;
+    }
+    // 2:1 balance: a refined leaf drags coarser neighbours along
+    int grew;
+    do {
+        grew = 0;
+        for (int i = 0; i < nl; i++) {
+            int n = t->leaves[i];
+            if (!refine[n]) continue;
+            int cnt = face_neighbours(t, n, nbr);
+            for (int c = 0; c < cnt; c++) {
+                if (t->p[nbr[c]].level < t->p[n].level && !refine[nbr[c]]) {
+                    refine[nbr[c]] = 1;
+                    grew = 1;
+                }
+            }
+        }
+    } while (grew);
+    // Coarsen four quiet sibling leaves unless a neighbour would end up two levels finer
+    for (int n = 0; n < nn; n++) {
+        patch_t *p = &t->p[n];
+        if (!p->alive || p->child[0] < 0 || p->level + 1 <= BASE_LEVEL) continue;
+        int ok = 1;
+        for (int c = 0; c < 4 && ok; c++) {
+            int ch = p->child[c];
+            if (t->p[ch].child[0] >= 0 || leaf_flag[ch] >= 0 || refine[ch]) ok = 0;
+        }
+        for (int c = 0; c < 4 && ok; c++) {
+            int ch = p->child[c];
+            int cnt = face_neighbours(t, ch, nbr);
+            for (int s = 0; s < cnt; s++) {
+                if (t->p[nbr[s]].parent != n && t->p[nbr[s]].level + refine[nbr[s]] > t->p[ch].level) ok = 0;
+            }
+        }
+        coarsen[n] = ok;
+    }
+
+    int *new_owner = (int *)malloc(nn * sizeof(int));
+    for (int n = 0; n < nn; n++) new_owner[n] = t->p[n].owner;
+    for (int n = 0; n < nn; n++) {
+        if (!coarsen[n]) continue;
+        for (int c = 1; c < 4; c++) new_owner[t->p[n].child[c]] = t->p[t->p[n].child[0]].owner;
+    }
+    drop_remote_copies(t);
+    migrate(t, new_owner);
+
+    // Coarsen: the parent takes the 2x2 averages of its children
+    for (int n = 0; n < nn; n++) {
+        if (!coarsen[n]) continue;
+        patch_t *p = &t->p[n];
+        p->owner = t->p[p->child[0]].owner;
+        if (p->owner == rank) {
+            alloc_leaf(t, n);
+            for (int a = 0; a < PATCH; a++) {
+                for (int b = 0; b < PATCH; b++) {
+                    const patch_t *ch = &t->p[p->child[2 * (2 * a / PATCH) + 2 * b / PATCH]];
+                    int ca = 2 * (a % (PATCH / 2)), cb = 2 * (b % (PATCH / 2));
+                    p->u[(a + 1) * STRIDE + b + 1] = 0.25 * (cell(ch, ca, cb) + cell(ch, ca + 1, cb) +
+                                                             cell(ch, ca, cb + 1) + cell(ch, ca + 1, cb + 1));
+                }
+            }
+        }
+        for (int c = 0; c < 4; c++) {
+            free_leaf(&t->p[p->child[c]]);
+            t->p[p->child[c]].alive = 0;
+        }
+        p->child[0] = -1;
+        changes++;
+    }
+
+    // Refine: children start from slope-corrected parent values
+    for (int n = 0; n < nn; n++) {
+        if (!refine[n]) continue;
+        split(t, n);
+        patch_t *p = &t->p[n];
+        if (p->owner == rank) {
+            for (int c = 0; c < 4; c++) {
+                int ch = p->child[c];
+                alloc_leaf(t, ch);
+                patch_t *q = &t->p[ch];
+                for (int a = 0; a < PATCH; a++) {
+                    for (int b = 0; b < PATCH; b++) {
+                        int pa = (c / 2) * PATCH / 2 + a / 2 + 1, pb = (c % 2) * PATCH / 2 + b / 2 + 1;
+                        const double *pu = p->u;
+                        double sa = 0.5 * (pu[(pa + 1) * STRIDE + pb] - pu[(pa - 1) * STRIDE + pb]);
+                        double sb = 0.5 * (pu[pa * STRIDE + pb + 1] - pu[pa * STRIDE + pb - 1]);
+                        q->u[(a + 1) * STRIDE + b + 1] = pu[pa * STRIDE + pb] +
+                            ((a & 1) ? 0.25 : -0.25) * sa + ((b & 1) ? 0.25 : -0.25) * sb;
+                    }
+                }
+            }
+            free_leaf(p);
+        }
+        changes++;
+    }
+
+    // Rebalance in Morton order
+    order_leaves(t);
+    free(new_owner);
+    new_owner = (int *)malloc(t->n * sizeof(int));
+    for (int n = 0; n < t->n; n++) new_owner[n] = t->p[n].owner;
+    for (int r = 0; r < size; r++) {
+        for (int i = (int)((long)r * t->nleaves / size); i < (int)((long)(r + 1) * t->nleaves / size); i++) {
+            new_owner[t->leaves[i]] = r;
+        }
+    }
+    migrate(t, new_owner);
+    exchange_build(t, ex);
+
+    free(new_owner);
+    free(leaf_flag);
+    free(refine);
+    free(coarsen);
+    free(nbr);
+    free(displs);
+    free(counts);
+    free(flag);
+    return changes;
+}
+
+int main(int argc, char **argv) {
+    tree_t tree;
+    exchange_t ex;
+    double start_time, end_time;
+    int cycle, iter, i, converged = 0;
+
+    // Initialize MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Dirichlet edge temperatures (optional config file argument)
+    heat_config_default(&cfg);
+    if (argc > 1) {
+        if (heat_config_load(argv[1], &cfg) != 0) {
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        for (i = 0; i < NUM_EDGES; i++) {
+            if (cfg.type[i] != BC_DIRICHLET || cfg.source_file[0] != '\0' ||
+                cfg.conductivity_file[0] != '\0') {
+                if (rank == 0) {
+                    fprintf(stderr, "heat_amr supports Dirichlet edges and uniform conductivity only; "
+                                    "the source is built in\n");
+                }
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+        }
+        if (rank == 0) {
+            heat_config_print(&cfg);
+        }
+    }
+
+    // Start timing
+    start_time = MPI_Wtime();
+
+    // Uniform base mesh
+    memset(&tree, 0, sizeof(tree));
+    memset(&ex, 0, sizeof(ex));
+    new_node(&tree, 0, 0, 0, -1);
+    for (int l = 0; l < BASE_LEVEL; l++) {
+        int n0 = tree.n;
+        for (int n = 0; n < n0; n++) {
+            if (tree.p[n].child[0] < 0) split(&tree, n);
+        }
+    }
+    order_leaves(&tree);
+    for (i = 0; i < tree.nleaves; i++) {
+        int n = tree.leaves[i];
+        for (int r = 0; r < size; r++) {
+            if (i >= (int)((long)r * tree.nleaves / size)) tree.p[n].owner = r;
+        }
+        if (tree.p[n].owner == rank) alloc_leaf(&tree, n);
+    }
+    exchange_build(&tree, &ex);
+
+    // Solve, regrid, repeat
+    for (cycle = 0; cycle < MAX_CYCLES; cycle++) {
+        double max_diff;
+        iter = solve(&tree, &ex, &max_diff);
+        converged = (max_diff < TOLERANCE);
+        if (rank == 0) {
+            int per_level[MAX_LEVEL + 1] = { 0 };
+            for (i = 0; i < tree.nleaves; i++) per_level[tree.p[tree.leaves[i]].level]++;
+            printf("Cycle %d: %d patches [", cycle, tree.nleaves);
+            for (int l = BASE_LEVEL; l <= MAX_LEVEL; l++) printf(" L%d:%d", l, per_level[l]);
+            if (converged) {
+                printf(" ], converged after %d iterations.\n", iter);
+            } else {
+                printf(" ], NOT converged: max change %e after %d iterations.\n", max_diff, iter);
+            }
+        }
+        if (cycle == MAX_CYCLES - 1 || regrid(&tree, &ex) == 0) break;
+    }
+
+    // End timing
+    end_time = MPI_Wtime();
+
+    // Area-weighted mean, peak and storage compared with a uniform fine grid
+    double local[2] = { 0.0, -HUGE_VAL }, global[2];
+    int finest = 0;
+    for (i = 0; i < tree.nleaves; i++) {
+        const patch_t *q = &tree.p[tree.leaves[i]];
+        if (q->level > finest) finest = q->level;
+        if (i < tree.lo || i >= tree.hi) continue;
+        double h = 1.0 / (PATCH << q->level);
+        for (int a = 0; a < PATCH; a++) {
+            for (int b = 0; b < PATCH; b++) {
+                local[0] += h * h * cell(q, a, b);
+                local[1] = fmax(local[1], cell(q, a, b));
+            }
+        }
+    }
+    MPI_Reduce(&local[0], &global[0], 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&local[1], &global[1], 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        long cells = (long)tree.nleaves * PATCH * PATCH;
+        long uniform = (long)(PATCH << finest) * (PATCH << finest);
+        printf("Finest level %d: effective %dx%d grid\n", finest, PATCH << finest, PATCH << finest);
+        printf("Cells stored: %ld (%.1f%% of the uniform grid)\n", cells, 100.0 * cells / uniform);
+        printf("Mean temperature: %.6f\n", global[0]);
+        printf("Peak temperature: %.6f\n", global[1]);
+        printf("AMR execution time: %f seconds\n", end_time - start_time);
+        if (!converged) {
+            fprintf(stderr, "Error: the final cycle did not converge to %g\n", TOLERANCE);
+        }
+    }
+
+    // Free memory
+    for (i = 0; i < tree.n; i++) {
+        if (tree.p[i].alive) free_leaf(&tree.p[i]);
+    }
+    free(tree.p);
+    free(tree.leaves);
+    exchange_free(&ex);
+
+    MPI_Finalize();
+    return converged ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#ifndef HEAT_ARENA_H
+#define HEAT_ARENA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+// Arena allocator for solver buffers, shared by the serial and MPI drivers.
+//
+// One mapping holds the grids, halo pack buffers and scratch. It is first
+// requested from the hugetlb pool (MAP_HUGETLB). If no huge pages are
+// reserved, an ordinary mapping aligned to 2 MiB is advised for transparent
+// huge pages (MADV_HUGEPAGE). Buffers are carved out with a bump pointer
+// and released all at once. heat_arena_report reads /proc/self/smaps to show
+// which pages the kernel actually used, so call it after first touch.
+
+#define HEAT_ARENA_ALIGN 64
+#define HEAT_HUGE_PAGE (2UL << 20)
+
+typedef struct {
+    char *base;
+    size_t size, used;
+    const char *kind;           // How the mapping was obtained
+} heat_arena_t;
+
+static inline size_t heat_arena_round(size_t bytes, size_t align) {
+    return (bytes + align - 1) & ~(align - 1);
+}
+
+// Map at least `bytes`; returns 0 on success, -1 on failure
+static inline int heat_arena_init(heat_arena_t *a, size_t bytes) {
+    size_t size = heat_arena_round(bytes, HEAT_HUGE_PAGE);
+    void *p = MAP_FAILED;
+
+    memset(a, 0, sizeof(*a));
+#ifdef MAP_HUGETLB
+    p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+        a->kind = "hugetlb";
+    }
+#endif
+    if (p == MAP_FAILED) {
+        // Over-allocate so the arena can start on a huge-page boundary
+        size_t span = size + HEAT_HUGE_PAGE;
+        char *raw = (char *)mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            perror("heat_arena_init: mmap");
+            return -1;
+        }
+        char *aligned = (char *)heat_arena_round((uintptr_t)raw, HEAT_HUGE_PAGE);
+        if (aligned > raw) munmap(raw, aligned - raw);
+        if (aligned + size < raw + span) munmap(aligned + size, raw + span - (aligned + size));
+        p = aligned;
+        a->kind = "4 KiB pages";
+#ifdef MADV_HUGEPAGE
+        if (madvise(p, size, MADV_HUGEPAGE) == 0) {
+            a->kind = "transparent huge pages";
+        }
+#endif
+    }
+    a->base = (char *)p;
+    a->size = size;
+    return 0;
+}
+
+// Aligned block from the arena, or NULL if it is exhausted
+static inline void *heat_arena_alloc(heat_arena_t *a, size_t bytes) {
+    size_t start = heat_arena_round(a->used, HEAT_ARENA_ALIGN);
+    if (start + bytes > a->size) {
+        fprintf(stderr, "heat_arena_alloc: arena of %zu bytes exhausted\n", a->size);
+        return NULL;
+    }
+    a->used = start + bytes;
+    return a->base + start;
+}
+
+// Row stride of a grid: rows start on HEAT_ARENA_ALIGN boundaries
+static inline size_t heat_arena_stride(int ny) {
+    return heat_arena_round((size_t)ny * sizeof(double), HEAT_ARENA_ALIGN) / sizeof(double);
+}
+
+// Bytes heat_arena_grid needs, including alignment slack
+static inline size_t heat_arena_grid_bytes(int nx, int ny) {
+    return heat_arena_round((size_t)nx * sizeof(double *), HEAT_ARENA_ALIGN) +
+           (size_t)nx * heat_arena_stride(ny) * sizeof(double) + HEAT_ARENA_ALIGN;
+}
+
+// nx x ny grid as row pointers into one contiguous block
+static inline double **heat_arena_grid(heat_arena_t *a, int nx, int ny) {
+    size_t stride = heat_arena_stride(ny);
+    double **rows = (double **)heat_arena_alloc(a, (size_t)nx * sizeof(double *));
+    double *data = (double *)heat_arena_alloc(a, (size_t)nx * stride * sizeof(double));
+    if (rows == NULL || data == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < nx; i++) {
+        rows[i] = data + (size_t)i * stride;
+    }
+    return rows;
+}
+
+// Print the arena size, how it was mapped and the page sizes backing it
+static inline void heat_arena_report(const heat_arena_t *a, FILE *out) {
+    FILE *f = fopen("/proc/self/smaps", "r");
+    char line[256];
+    long kernel_kb = -1, thp_kb = -1;
+    int inside = 0;
+
+    if (f != NULL) {
+        while (fgets(line, sizeof(line), f) != NULL) {
+            unsigned long lo, hi;
+            // Mapping headers start with the address range, fields with a capitalised name
+            if (!(line[0] >= 'A' && line[0] <= 'Z') && sscanf(line, "%lx-%lx ", &lo, &hi) == 2) {
+                if (inside) break;
+                inside = ((uintptr_t)a->base >= lo && (uintptr_t)a->base < hi);
+            } else if (inside) {
+                sscanf(line, "KernelPageSize: %ld kB", &kernel_kb);
+                sscanf(line, "AnonHugePages: %ld kB", &thp_kb);
+            }
+        }
+        fclose(f);
+    }
+    fprintf(out, "Arena: %.1f MB (%.1f MB used), %s", a->size / 1e6, a->used / 1e6, a->kind);
+    if (kernel_kb > 0) {
+        fprintf(out, ", page size %ld kB", kernel_kb);
+    }
+    if (thp_kb >= 0) {
+        fprintf(out, ", %ld kB in huge pages", thp_kb);
+    }
+    fprintf(out, "\n");
+}
+
+static inline void heat_arena_free(heat_arena_t *a) {
+    if (a->base != NULL) {
+        munmap(a->base, a->size);
+    }
+    memset(a, 0, sizeof(*a));
+}
+
+#endif
@@ -0,0 +1,301 @@
+#ifndef HEAT_CONFIG_H
+#define HEAT_CONFIG_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "heat_stencil.h"
+
+// Shared boundary-condition and source-term configuration for the serial
+// and MPI drivers.
+//
+// Config file format (one setting per line, '#' starts a comment):
+//
+//     north  = dirichlet 100.0    # row i = 0
+//     south  = neumann 0.0        # row i = NX-1, outward du/dn
+//     west   = periodic           # column j = 0
+//     east   = periodic           # column j = NY-1
+//     source = source.txt         # NX*NY values, row-major
+//     conductivity = k.txt float  # NX*NY positive values; 'float' stores the
+//                                 # face coefficients in single precision
+//
+// Edges not mentioned keep the default Dirichlet 100.0. Periodic edges must
+// come in opposite pairs. Without a conductivity map it is 1 everywhere.
+
+typedef enum { BC_DIRICHLET, BC_NEUMANN, BC_PERIODIC } bc_type_t;
+
+enum { EDGE_NORTH, EDGE_SOUTH, EDGE_WEST, EDGE_EAST, NUM_EDGES };
+
+typedef struct {
+    bc_type_t type[NUM_EDGES];
+    double value[NUM_EDGES];        // Dirichlet value or Neumann gradient
+    char source_file[256];          // Empty if there is no source term
+    char conductivity_file[256];    // Empty for uniform conductivity
+    int conductivity_float;         // Face coefficients stored as float
+} heat_config_t;
+
+static inline const char *heat_edge_name(int edge) {
+    static const char *names[NUM_EDGES] = { "north", "south", "west", "east" };
+    return names[edge];
+}
+
+static inline const char *heat_bc_name(bc_type_t type) {
+    static const char *names[] = { "dirichlet", "neumann", "periodic" };
+    return names[type];
+}
+
+static inline void heat_config_default(heat_config_t *cfg) {
+    for (int e = 0; e < NUM_EDGES; e++) {
+        cfg->type[e] = BC_DIRICHLET;
+        cfg->value[e] = 100.0;
+    }
+    cfg->source_file[0] = '\0';
+    cfg->conductivity_file[0] = '\0';
+    cfg->conductivity_float = 0;
+}
+
+// Load settings from a config file on top of the defaults; returns 0 on success
+static inline int heat_config_load(const char *filename, heat_config_t *cfg) {
+    char line[512], key[64], kind[64], path[256];
+    int lineno = 0;
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "Error: Could not open config file %s\n", filename);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char *hash = strchr(line, '#');
+        char *eq = strchr(line, '=');
+        double value = 0.0;
+        int e, n;
+
+        lineno++;
+        if (hash != NULL) *hash = '\0';
+        if (sscanf(line, " %63s", key) != 1) continue;
+        if (eq == NULL) {
+            fprintf(stderr, "Error: %s:%d: expected 'key = value'\n", filename, lineno);
+            fclose(fp);
+            return -1;
+        }
+        *eq = '\0';
+        sscanf(line, " %63[^ \t=]", key);
+
+        if (strcmp(key, "source") == 0) {
+            if (sscanf(eq + 1, " %255s", path) != 1) {
+                fprintf(stderr, "Error: %s:%d: missing source file name\n", filename, lineno);
+                fclose(fp);
+                return -1;
+            }
+            strcpy(cfg->source_file, path);
+            continue;
+        }
+        if (strcmp(key, "conductivity") == 0) {
+            n = sscanf(eq + 1, " %255s %63s", path, kind);
+            if (n < 1 || (n == 2 && strcmp(kind, "float") != 0 && strcmp(kind, "double") != 0)) {
+                fprintf(stderr, "Error: %s:%d: expected 'conductivity = file [float|double]'\n",
+                        filename, lineno);
+                fclose(fp);
+                return -1;
+            }
+            strcpy(cfg->conductivity_file, path);
+            cfg->conductivity_float = (n == 2 && strcmp(kind, "float") == 0);
+            continue;
+        }
+
+        for (e = 0; e < NUM_EDGES; e++) {
+            if (strcmp(key, heat_edge_name(e)) == 0) break;
+        }
+        n = sscanf(eq + 1, " %63s %lf", kind, &value);
+        if (e == NUM_EDGES || n < 1) {
+            fprintf(stderr, "Error: %s:%d: unknown setting '%s'\n", filename, lineno, key);
+            fclose(fp);
+            return -1;
+        }
+
+        if (strcmp(kind, "dirichlet") == 0 && n == 2) {
+            cfg->type[e] = BC_DIRICHLET;
+        } else if (strcmp(kind, "neumann") == 0 && n == 2) {
+            cfg->type[e] = BC_NEUMANN;
+        } else if (strcmp(kind, "periodic") == 0) {
+            cfg->type[e] = BC_PERIODIC;
+            value = 0.0;
+        } else {
+            fprintf(stderr, "Error: %s:%d: bad boundary condition for %s\n",
+                    filename, lineno, key);
+            fclose(fp);
+            return -1;
+        }
+        cfg->value[e] = value;
+    }
+    fclose(fp);
+
+    if ((cfg->type[EDGE_NORTH] == BC_PERIODIC) != (cfg->type[EDGE_SOUTH] == BC_PERIODIC) ||
+        (cfg->type[EDGE_WEST] == BC_PERIODIC) != (cfg->type[EDGE_EAST] == BC_PERIODIC)) {
+        fprintf(stderr, "Error: %s: periodic edges must come in opposite pairs\n", filename);
+        return -1;
+    }
+    return 0;
+}
+
+static inline void heat_config_print(const heat_config_t *cfg) {
+    for (int e = 0; e < NUM_EDGES; e++) {
+        printf("  %-5s: %s", heat_edge_name(e), heat_bc_name(cfg->type[e]));
+        if (cfg->type[e] != BC_PERIODIC) printf(" %g", cfg->value[e]);
+        printf("\n");
+    }
+    if (cfg->source_file[0] != '\0') {
+        printf("  source: %s\n", cfg->source_file);
+    }
+    if (cfg->conductivity_file[0] != '\0') {
+        printf("  conductivity: %s (%s coefficients)\n", cfg->conductivity_file,
+               cfg->conductivity_float ? "float" : "double");
+    }
+}
+
+// Read an nx*ny field (row-major), named `what` in error messages; returns
+// NULL on error
+static inline double *heat_field_load(const char *filename, const char *what, int nx, int ny) {
+    FILE *fp = fopen(filename, "r");
+    double *f;
+    if (fp == NULL) {
+        fprintf(stderr, "Error: Could not open %s file %s\n", what, filename);
+        return NULL;
+    }
+    f = (double *)malloc((size_t)nx * ny * sizeof(double));
+    for (long k = 0; k < (long)nx * ny; k++) {
+        if (fscanf(fp, "%lf", &f[k]) != 1) {
+            fprintf(stderr, "Error: %s: expected %d x %d values\n", filename, nx, ny);
+            free(f);
+            fclose(fp);
+            return NULL;
+        }
+    }
+    fclose(fp);
+    return f;
+}
+
+// Read an nx*ny source field (row-major); returns NULL on error
+static inline double *heat_source_load(const char *filename, int nx, int ny) {
+    return heat_field_load(filename, "source", nx, ny);
+}
+
+// Initial value of a global grid point: Dirichlet edges hold their value,
+// everything else starts at zero
+static inline double heat_initial_value(const heat_config_t *cfg, int i, int j, int nx, int ny) {
+    if (j == 0 && cfg->type[EDGE_WEST] == BC_DIRICHLET) return cfg->value[EDGE_WEST];
+    if (j == ny - 1 && cfg->type[EDGE_EAST] == BC_DIRICHLET) return cfg->value[EDGE_EAST];
+    if (i == 0 && cfg->type[EDGE_NORTH] == BC_DIRICHLET) return cfg->value[EDGE_NORTH];
+    if (i == nx - 1 && cfg->type[EDGE_SOUTH] == BC_DIRICHLET) return cfg->value[EDGE_SOUTH];
+    return 0.0;
+}
+
+// Jacobi update of row i, columns [j0, j1): the 5-point stencil of
+// heat_stencil.h. The boundary conditions only touch edge rows/columns, so the
+// body has no per-point branches; has_source is a compile-time constant in
+// each wrapper below. The source field f is indexed as f[i * f_stride + j].
+static inline __attribute__((always_inline))
+double heat_sweep_row(double **u, double **u_new, const double *f, int f_stride,
+                      int i, int j0, int j1, const int has_source) {
+    return stencil_5pt_row(u, u_new, f, f_stride, i, j0, j1, has_source);
+}
+
+// Jacobi update of rows [i0, i1) and columns [j0, j1), rows shared among threads
+static inline __attribute__((always_inline))
+double heat_sweep_body(double **u, double **u_new, const double *f, int f_stride,
+                       int i0, int i1, int j0, int j1, const int has_source) {
+    int i;
+    double diff, max_diff = 0.0;
+
+#ifdef _OPENMP
+    #pragma omp parallel for private(diff) reduction(max:max_diff)
+#endif
+    for (i = i0; i < i1; i++) {
+        diff = heat_sweep_row(u, u_new, f, f_stride, i, j0, j1, has_source);
+        if (diff > max_diff) {
+            max_diff = diff;
+        }
+    }
+    return max_diff;
+}
+
+static inline double heat_sweep_plain(double **u, double **u_new, const double *f, int f_stride,
+                                      int i0, int i1, int j0, int j1) {
+    return heat_sweep_body(u, u_new, f, f_stride, i0, i1, j0, j1, 0);
+}
+
+static inline double heat_sweep_source(double **u, double **u_new, const double *f, int f_stride,
+                                       int i0, int i1, int j0, int j1) {
+    return heat_sweep_body(u, u_new, f, f_stride, i0, i1, j0, j1, 1);
+}
+
+typedef double (*heat_sweep_fn)(double **, double **, const double *, int, int, int, int, int);
+
+// Single-threaded sweep of one block (f may be NULL), for callers that
+// already spread blocks over threads
+static inline double heat_sweep_block(double **u, double **u_new, const double *f, int f_stride,
+                                      int i0, int i1, int j0, int j1) {
+    double diff, max_diff = 0.0;
+    for (int i = i0; i < i1; i++) {
+        diff = (f != NULL) ? heat_sweep_row(u, u_new, f, f_stride, i, j0, j1, 1)
+                           : heat_sweep_row(u, u_new, f, f_stride, i, j0, j1, 0);
+        if (diff > max_diff) {
+            max_diff = diff;
+        }
+    }
+    return max_diff;
+}
+
+// Pick the kernel specialization once, outside the iteration loop
+static inline heat_sweep_fn heat_select_sweep(const double *source) {
+    return (source != NULL) ? heat_sweep_source : heat_sweep_plain;
+}
+
+// Edge fills: copy a row/column with an offset
+static inline void heat_fill_row(double **u, int dst, int src, int j0, int j1, double offset) {
+    for (int j = j0; j < j1; j++) {
+        u[dst][j] = u[src][j] + offset;
+    }
+}
+
+static inline void heat_fill_col(double **u, int dst, int src, int i0, int i1, double offset) {
+    for (int i = i0; i < i1; i++) {
+        u[i][dst] = u[i][src] + offset;
+    }
+}
+
+// Refresh non-Dirichlet edges of a local block of nx rows and ny columns
+// (including the edge/ghost lines). has_west/has_east say whether the first
+// and last local columns are global edges. Periodic columns are only filled
+// when the block spans the full width; otherwise the halo exchange does it.
+static inline void heat_apply_bc(const heat_config_t *cfg, double **u, int nx, int ny,
+                          int has_west, int has_east) {
+    switch (cfg->type[EDGE_NORTH]) {
+        case BC_NEUMANN:  heat_fill_row(u, 0, 1, 1, ny - 1, cfg->value[EDGE_NORTH]); break;
+        case BC_PERIODIC: heat_fill_row(u, 0, nx - 2, 1, ny - 1, 0.0); break;
+        default: break;
+    }
+    switch (cfg->type[EDGE_SOUTH]) {
+        case BC_NEUMANN:  heat_fill_row(u, nx - 1, nx - 2, 1, ny - 1, cfg->value[EDGE_SOUTH]); break;
+        case BC_PERIODIC: heat_fill_row(u, nx - 1, 1, 1, ny - 1, 0.0); break;
+        default: break;
+    }
+    if (has_west) {
+        switch (cfg->type[EDGE_WEST]) {
+            case BC_NEUMANN:  heat_fill_col(u, 0, 1, 1, nx - 1, cfg->value[EDGE_WEST]); break;
+            case BC_PERIODIC: if (has_east) heat_fill_col(u, 0, ny - 2, 1, nx - 1, 0.0); break;
+            default: break;
+        }
+    }
+    if (has_east) {
+        switch (cfg->type[EDGE_EAST]) {
+            case BC_NEUMANN:  heat_fill_col(u, ny - 1, ny - 2, 1, nx - 1, cfg->value[EDGE_EAST]); break;
+            case BC_PERIODIC: if (has_west) heat_fill_col(u, ny - 1, 1, 1, nx - 1, 0.0); break;
+            default: break;
+        }
+    }
+}
+
+#endif
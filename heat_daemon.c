@@ -0,0 +1,479 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "libheat.h"
+
+#define NX 500
+#define NY 500
+#define MAX_ITER 100000         // Default per-job cap; jobs run to convergence
+#define TOLERANCE 1e-6
+
+#define NUM_WORKERS 4
+#define QUEUE_LENGTH 64
+#define CACHE_ENTRIES 64
+#define RESOLUTION_WEIGHT 1.0   // Cache distance per factor of two in grid size
+
+// Local solver daemon with a warm-start solution cache.
+//
+//   ./heat_daemon [socket] [workers]               # serve
+//   ./heat_daemon --client [socket] [request]      # send one request, or stdin lines
+//
+// Clients connect to a UNIX domain socket and send one request per line:
+//
+//   solve nx=200 ny=200 north=120 south=neumann:0 west=100 east=100 tol=1e-6
+//   stats
+//   shutdown
+//
+// Edges take a number (Dirichlet value), dirichlet:V, neumann:G or periodic.
+// Each reply is one line, "ok key=value ..." or "error message".
+//
+// Worker threads keep their libheat solver between jobs and only reallocate
+// when the grid size changes (heat_reset reuses the buffers). Every converged
+// solution is cached under its grid size and boundary conditions. A new job
+// starts from the nearest cached solution with the same edge types, measured
+// by the Dirichlet/Neumann value differences plus RESOLUTION_WEIGHT per factor
+// of two in grid size, and is interpolated bilinearly if the size differs. The
+// reply reports the iterations saved against the cold-start count recorded
+// for that lineage (scaled by n^2 across resolutions, as for Jacobi).
+
+typedef struct {
+    int nx, ny, max_iter, warm;
+    double tol;
+    heat_config_t cfg;
+} job_t;
+
+typedef struct {
+    int nx, ny;
+    heat_config_t cfg;
+    double *field;              // nx * ny converged values, row-major
+    double cold_iterations;     // Iterations a cold start needs (measured or estimated)
+    unsigned long last_used;
+} cache_entry_t;
+
+static struct {
+    pthread_mutex_t lock;
+    cache_entry_t entry[CACHE_ENTRIES];
+    int count;
+    unsigned long clock;
+    long jobs, hits, iterations, saved;
+} cache = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// Accepted connections waiting for a worker
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    int fd[QUEUE_LENGTH];
+    int head, count, closed;
+} queue = { .lock = PTHREAD_MUTEX_INITIALIZER, .ready = PTHREAD_COND_INITIALIZER };
+
+static int listen_fd = -1;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// Parse "solve key=value ..."; returns 0 or writes a message to err
+static int parse_job(char *line, job_t *job, char *err, size_t errlen) {
+    char *save, *tok;
+
+    job->nx = NX;
+    job->ny = NY;
+    job->max_iter = MAX_ITER;
+    job->tol = TOLERANCE;
+    job->warm = 1;
+    heat_config_default(&job->cfg);
+    strtok_r(line, " \t\r\n", &save);
+    while ((tok = strtok_r(NULL, " \t\r\n", &save)) != NULL) {
+        char *value = strchr(tok, '=');
+        int e;
+        if (value == NULL) {
+            snprintf(err, errlen, "expected key=value, got '%s'", tok);
+            return -1;
+        }
+        *value++ = '\0';
+        if (strcmp(tok, "nx") == 0) { job->nx = atoi(value); continue; }
+        if (strcmp(tok, "ny") == 0) { job->ny = atoi(value); continue; }
+        if (strcmp(tok, "max_iter") == 0) { job->max_iter = atoi(value); continue; }
+        if (strcmp(tok, "tol") == 0) { job->tol = atof(value); continue; }
+        if (strcmp(tok, "warm") == 0) { job->warm = atoi(value); continue; }
+        for (e = 0; e < NUM_EDGES; e++) {
+            if (strcmp(tok, heat_edge_name(e)) == 0) break;
+        }
+        if (e == NUM_EDGES) {
+            snprintf(err, errlen, "unknown key '%s'", tok);
+            return -1;
+        }
+        char *colon = strchr(value, ':');
+        if (strcmp(value, "periodic") == 0) {
+            job->cfg.type[e] = BC_PERIODIC;
+            job->cfg.value[e] = 0.0;
+        } else if (colon != NULL && strncmp(value, "neumann", colon - value) == 0) {
+            job->cfg.type[e] = BC_NEUMANN;
+            job->cfg.value[e] = atof(colon + 1);
+        } else if (colon != NULL && strncmp(value, "dirichlet", colon - value) == 0) {
+            job->cfg.type[e] = BC_DIRICHLET;
+            job->cfg.value[e] = atof(colon + 1);
+        } else if (colon == NULL) {
+            job->cfg.type[e] = BC_DIRICHLET;
+            job->cfg.value[e] = atof(value);
+        } else {
+            snprintf(err, errlen, "bad boundary condition '%s' for %s", value, tok);
+            return -1;
+        }
+    }
+    if (job->nx < 3 || job->ny < 3 || job->max_iter < 1 || !(job->tol > 0.0)) {
+        snprintf(err, errlen, "need nx, ny >= 3, max_iter >= 1 and tol > 0");
+        return -1;
+    }
+    if ((job->cfg.type[EDGE_NORTH] == BC_PERIODIC) != (job->cfg.type[EDGE_SOUTH] == BC_PERIODIC) ||
+        (job->cfg.type[EDGE_WEST] == BC_PERIODIC) != (job->cfg.type[EDGE_EAST] == BC_PERIODIC)) {
+        snprintf(err, errlen, "periodic edges must come in opposite pairs");
+        return -1;
+    }
+    return 0;
+}
+
+// Distance from a cached entry to a job; INFINITY if the edge types differ
+static double cache_distance(const cache_entry_t *c, const job_t *job) {
+    double d2 = 0.0;
+    for (int e = 0; e < NUM_EDGES; e++) {
+        if (c->cfg.type[e] != job->cfg.type[e]) return INFINITY;
+        double dv = c->cfg.value[e] - job->cfg.value[e];
+        d2 += dv * dv;
+    }
+    return sqrt(d2) + RESOLUTION_WEIGHT * (fabs(log2((double)job->nx / c->nx)) +
+                                           fabs(log2((double)job->ny / c->ny)));
+}
+
+// Bilinear interpolation of a cached solution into the solver's interior
+static void warm_start(heat_solver_t *solver, const cache_entry_t *c) {
+    heat_field_t f = heat_field(solver);
+    double sx = (double)(c->nx - 1) / (f.nx - 1), sy = (double)(c->ny - 1) / (f.ny - 1);
+
+    for (int i = 1; i < f.nx - 1; i++) {
+        double x = i * sx;
+        int i0 = (int)x < c->nx - 1 ? (int)x : c->nx - 2;
+        double wx = x - i0;
+        const double *r0 = c->field + (long)i0 * c->ny, *r1 = r0 + c->ny;
+        double *out = f.data + i * f.stride;
+        for (int j = 1; j < f.ny - 1; j++) {
+            double y = j * sy;
+            int j0 = (int)y < c->ny - 1 ? (int)y : c->ny - 2;
+            double wy = y - j0;
+            out[j] = (1.0 - wx) * ((1.0 - wy) * r0[j0] + wy * r0[j0 + 1]) +
+                     wx * ((1.0 - wy) * r1[j0] + wy * r1[j0 + 1]);
+        }
+    }
+}
+
+// Find the nearest entry and warm-start from it; returns its cold-start
+// estimate scaled to this job, or 0 for a cold start
+static double cache_lookup(heat_solver_t *solver, const job_t *job, double *distance) {
+    double best = INFINITY, estimate = 0.0;
+    int k, hit = -1;
+
+    pthread_mutex_lock(&cache.lock);
+    for (k = 0; k < cache.count; k++) {
+        double d = cache_distance(&cache.entry[k], job);
+        if (d < best) {
+            best = d;
+            hit = k;
+        }
+    }
+    if (hit >= 0) {
+        cache_entry_t *c = &cache.entry[hit];
+        double n = (job->nx > job->ny) ? job->nx : job->ny;
+        double n_c = (c->nx > c->ny) ? c->nx : c->ny;
+        warm_start(solver, c);
+        c->last_used = ++cache.clock;
+        cache.hits++;
+        estimate = c->cold_iterations * (n / n_c) * (n / n_c);
+    }
+    pthread_mutex_unlock(&cache.lock);
+    *distance = best;
+    return estimate;
+}
+
+// Store a converged solution, replacing the same key or the least recently used entry
+static void cache_store(heat_solver_t *solver, const job_t *job, double cold_iterations) {
+    heat_field_t f = heat_field(solver);
+    int k, slot = -1;
+
+    pthread_mutex_lock(&cache.lock);
+    for (k = 0; k < cache.count && slot < 0; k++) {
+        cache_entry_t *c = &cache.entry[k];
+        if (c->nx == job->nx && c->ny == job->ny &&
+            memcmp(c->cfg.type, job->cfg.type, sizeof(c->cfg.type)) == 0 &&
+            memcmp(c->cfg.value, job->cfg.value, sizeof(c->cfg.value)) == 0) {
+            slot = k;
+        }
+    }
+    if (slot < 0 && cache.count < CACHE_ENTRIES) {
+        slot = cache.count++;
+    } else if (slot < 0) {
+        slot = 0;
+        for (k = 1; k < cache.count; k++) {
+            if (cache.entry[k].last_used < cache.entry[slot].last_used) slot = k;
+        }
+    }
+    cache_entry_t *c = &cache.entry[slot];
+    c->field = (double *)realloc(c->field, (size_t)job->nx * job->ny * sizeof(double));
+    for (int i = 0; i < job->nx; i++) {
+        memcpy(c->field + (long)i * job->ny, f.data + i * f.stride, job->ny * sizeof(double));
+    }
+    c->nx = job->nx;
+    c->ny = job->ny;
+    c->cfg = job->cfg;
+    c->cold_iterations = cold_iterations;
+    c->last_used = ++cache.clock;
+    pthread_mutex_unlock(&cache.lock);
+}
+
+// Run one job on the worker's solver; writes the reply line
+static void run_job(heat_solver_t **solver, const job_t *job, char *reply, size_t len) {
+    double t0 = now(), distance = INFINITY, estimate = 0.0;
+    int reused = 0;
+
+    // Keep the worker's grids when the size matches
+    heat_field_t f = (*solver != NULL) ? heat_field(*solver) : (heat_field_t){ 0 };
+    if (*solver != NULL && f.nx == job->nx && f.ny == job->ny) {
+        heat_reset(*solver, &job->cfg);
+        reused = 1;
+    } else {
+        heat_options_t opts;
+        heat_destroy(*solver);
+        heat_options_default(&opts, job->nx, job->ny);
+        opts.config = job->cfg;
+        *solver = heat_create(&opts);
+        if (*solver == NULL) {
+            snprintf(reply, len, "error cannot create a %d x %d solver\n", job->nx, job->ny);
+            return;
+        }
+    }
+    if (job->warm) {
+        estimate = cache_lookup(*solver, job, &distance);
+    }
+
+    int iter = heat_solve(*solver, job->max_iter, job->tol);
+    int iterations = (iter >= 0) ? iter + 1 : job->max_iter;
+    double cold = (estimate > 0.0) ? estimate : iterations;
+    long saved = (estimate > iterations) ? lround(estimate - iterations) : 0;
+    if (iter >= 0) {
+        cache_store(*solver, job, cold);
+    }
+
+    pthread_mutex_lock(&cache.lock);
+    cache.jobs++;
+    cache.iterations += iterations;
+    cache.saved += saved;
+    pthread_mutex_unlock(&cache.lock);
+
+    int n = snprintf(reply, len, "ok converged=%s iterations=%d", iter >= 0 ? "yes" : "no", iterations);
+    if (estimate > 0.0) {
+        n += snprintf(reply + n, len - n, " warm_start=yes distance=%.3g iterations_saved=%ld", distance, saved);
+    } else {
+        n += snprintf(reply + n, len - n, " warm_start=no iterations_saved=0");
+    }
+    snprintf(reply + n, len - n, " reused_buffers=%s average=%.6f seconds=%.6f\n",
+             reused ? "yes" : "no", heat_interior_average(*solver), now() - t0);
+}
+
+static void write_all(int fd, const char *buf) {
+    size_t left = strlen(buf);
+    while (left > 0) {
+        ssize_t done = write(fd, buf, left);
+        if (done <= 0) return;
+        buf += done;
+        left -= done;
+    }
+}
+
+// Handle request lines until the client closes the connection
+static void serve_connection(int fd, heat_solver_t **solver) {
+    FILE *in = fdopen(fd, "r");
+    char line[1024], reply[512], err[256];
+    job_t job;
+
+    while (in != NULL && fgets(line, sizeof(line), in) != NULL) {
+        char cmd[16] = "";
+        sscanf(line, "%15s", cmd);
+        if (strcmp(cmd, "solve") == 0) {
+            if (parse_job(line, &job, err, sizeof(err)) == 0) {
+                run_job(solver, &job, reply, sizeof(reply));
+            } else {
+                snprintf(reply, sizeof(reply), "error %s\n", err);
+            }
+        } else if (strcmp(cmd, "stats") == 0) {
+            pthread_mutex_lock(&cache.lock);
+            snprintf(reply, sizeof(reply), "ok jobs=%ld cache_entries=%d cache_hits=%ld iterations=%ld iterations_saved=%ld\n",
+                     cache.jobs, cache.count, cache.hits, cache.iterations, cache.saved);
+            pthread_mutex_unlock(&cache.lock);
+        } else if (strcmp(cmd, "shutdown") == 0) {
+            pthread_mutex_lock(&queue.lock);
+            queue.closed = 1;
+            pthread_mutex_unlock(&queue.lock);
+            shutdown(listen_fd, SHUT_RDWR);     // Wakes the accept loop
+            snprintf(reply, sizeof(reply), "ok shutting down\n");
+        } else if (cmd[0] == '\0') {
+            continue;
+        } else {
+            snprintf(reply, sizeof(reply), "error unknown command '%s'\n", cmd);
+        }
+        write_all(fd, reply);
+    }
+    if (in != NULL) {
+        fclose(in);
+    } else {
+        close(fd);
+    }
+}
+
+static void *worker_main(void *arg) {
+    heat_solver_t *solver = NULL;     // Kept between jobs
+    (void)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&queue.lock);
+        while (queue.count == 0 && !queue.closed) {
+            pthread_cond_wait(&queue.ready, &queue.lock);
+        }
+        if (queue.count == 0) {
+            pthread_mutex_unlock(&queue.lock);
+            break;
+        }
+        int fd = queue.fd[queue.head];
+        queue.head = (queue.head + 1) % QUEUE_LENGTH;
+        queue.count--;
+        pthread_mutex_unlock(&queue.lock);
+        serve_connection(fd, &solver);
+    }
+    heat_destroy(solver);
+    return NULL;
+}
+
+static int open_socket(const char *path, int server) {
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (fd < 0 || strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: cannot use socket %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    if (server) {
+        unlink(path);
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, QUEUE_LENGTH) != 0) {
+            perror(path);
+            close(fd);
+            return -1;
+        }
+    } else if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Send one request (or each line of stdin) and print the replies
+static int run_client(const char *path, int argc, char **argv) {
+    char line[1024] = "", reply[512];
+    int fd = open_socket(path, 0);
+    FILE *in;
+
+    if (fd < 0) return 1;
+    for (int k = 0; k < argc; k++) {
+        strncat(line, argv[k], sizeof(line) - strlen(line) - 2);
+        strcat(line, k + 1 < argc ? " " : "\n");
+    }
+    in = fdopen(fd, "r");
+    if (argc > 0) {
+        write_all(fd, line);
+        if (fgets(reply, sizeof(reply), in) != NULL) fputs(reply, stdout);
+    } else {
+        while (fgets(line, sizeof(line), stdin) != NULL) {
+            write_all(fd, line);
+            if (fgets(reply, sizeof(reply), in) == NULL) break;
+            fputs(reply, stdout);
+            fflush(stdout);
+        }
+    }
+    fclose(in);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *path = "heat_daemon.sock";
+    int workers = NUM_WORKERS;
+    pthread_t thread[64];
+
+    if (argc > 1 && strcmp(argv[1], "--client") == 0) {
+        if (argc > 2) path = argv[2];
+        return run_client(path, argc > 3 ? argc - 3 : 0, argv + 3);
+    }
+    if (argc > 1) path = argv[1];
+    if (argc > 2) workers = atoi(argv[2]);
+    if (workers < 1 || workers > 64) {
+        fprintf(stderr, "Usage: %s [socket] [workers 1..64]\n", argv[0]);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);   // Clients may leave before their reply
+    listen_fd = open_socket(path, 1);
+    if (listen_fd < 0) return 1;
+    for (int k = 0; k < workers; k++) {
+        pthread_create(&thread[k], NULL, worker_main, NULL);
+    }
+    printf("Listening on %s with %d workers\n", path, workers);
+    fflush(stdout);
+
+    // Accept until a client sends "shutdown"
+    for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        pthread_mutex_lock(&queue.lock);
+        if (queue.closed || queue.count == QUEUE_LENGTH) {
+            pthread_mutex_unlock(&queue.lock);
+            write_all(fd, "error daemon busy or shutting down\n");
+            close(fd);
+            continue;
+        }
+        queue.fd[(queue.head + queue.count) % QUEUE_LENGTH] = fd;
+        queue.count++;
+        pthread_cond_signal(&queue.ready);
+        pthread_mutex_unlock(&queue.lock);
+    }
+
+    pthread_mutex_lock(&queue.lock);
+    queue.closed = 1;
+    pthread_cond_broadcast(&queue.ready);
+    pthread_mutex_unlock(&queue.lock);
+    for (int k = 0; k < workers; k++) {
+        pthread_join(thread[k], NULL);
+    }
+    close(listen_fd);
+    unlink(path);
+
+    printf("Served %ld jobs: %ld iterations, %ld saved by warm starts\n",
+           cache.jobs, cache.iterations, cache.saved);
+    for (int k = 0; k < cache.count; k++) {
+        free(cache.entry[k].field);
+    }
+    return 0;
+}
@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+#include "heat_config.h"
+
+#define NX 500
+#define NY 500
+#define MAX_ITER 1000
+#define TOLERANCE 1e-6
+
+// Upper bound for the automatically chosen halo width
+#define MAX_HALO 32
+
+// Hybrid MPI+OpenMP solver with communication-avoiding deep halos.
+//
+//   mpirun -np P ./heat_deep_halo [k]
+//
+// Each rank keeps k ghost columns per side. One exchange of k columns is
+// followed by k Jacobi steps without communication: step s also updates the
+// k-1-s ghost columns that are still valid, so the valid region shrinks by
+// one column per step until the next exchange. Convergence is checked with one
+// reduction per block of k steps.
+//
+// Without k on the command line, it is chosen from a measured message latency
+// alpha and sweep cost gamma per point. Per step, the exchange costs alpha / k
+// and the redundant work costs about (k - 1) * NX * gamma, so the best width is
+// sqrt(alpha / (NX * gamma)). Bandwidth is not measured: an exchange moves
+// k * NX doubles once every k steps, i.e. NX doubles per step for any k, so
+// the bandwidth term is the same for every width and cannot move the optimum.
+
+// Exchange k ghost columns with both neighbours
+static void exchange_halo(double **u, double *send_buf, double *recv_buf, int k,
+                          int first, int last, int left, int right) {
+    int i, r;
+    for (i = 0; i < NX; i++)
+        for (r = 0; r < k; r++) send_buf[i * k + r] = u[i][first + r];
+    MPI_Sendrecv(send_buf, NX * k, MPI_DOUBLE, left, 0,
+                 recv_buf, NX * k, MPI_DOUBLE, right, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    if (right != MPI_PROC_NULL) {
+        for (i = 0; i < NX; i++)
+            for (r = 0; r < k; r++) u[i][last + r] = recv_buf[i * k + r];
+    }
+    for (i = 0; i < NX; i++)
+        for (r = 0; r < k; r++) send_buf[i * k + r] = u[i][last - k + r];
+    MPI_Sendrecv(send_buf, NX * k, MPI_DOUBLE, right, 1,
+                 recv_buf, NX * k, MPI_DOUBLE, left, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    if (left != MPI_PROC_NULL) {
+        for (i = 0; i < NX; i++)
+            for (r = 0; r < k; r++) u[i][first - k + r] = recv_buf[i * k + r];
+    }
+}
+
+// Pick k from a ping-pong latency and a timed sweep of a scratch block
+static int choose_halo_width(int left, int right, int max_k, double *alpha_out, double *gamma_out) {
+    const int reps = 200, cols = 64;
+    double token = 0.0, t0, alpha, gamma, in[2], out[2];
+    int i, rep;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    t0 = MPI_Wtime();
+    for (rep = 0; rep < reps; rep++) {
+        MPI_Sendrecv(&token, 1, MPI_DOUBLE, left, 2, &token, 1, MPI_DOUBLE, right, 2,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Sendrecv(&token, 1, MPI_DOUBLE, right, 3, &token, 1, MPI_DOUBLE, left, 3,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    }
+    alpha = (MPI_Wtime() - t0) / reps;
+
+    double **a = (double **)malloc(NX * sizeof(double *));
+    double **b = (double **)malloc(NX * sizeof(double *));
+    for (i = 0; i < NX; i++) {
+        a[i] = (double *)calloc(cols, sizeof(double));
+        b[i] = (double *)calloc(cols, sizeof(double));
+        a[i][0] = 100.0;
+    }
+    t0 = MPI_Wtime();
+    for (rep = 0; rep < 10; rep++) {
+        heat_sweep_plain(a, b, NULL, 0, 1, NX - 1, 1, cols - 1);
+    }
+    gamma = (MPI_Wtime() - t0) / (10.0 * (NX - 2) * (cols - 2));
+    for (i = 0; i < NX; i++) {
+        free(a[i]);
+        free(b[i]);
+    }
+    free(a);
+    free(b);
+
+    // Slowest link and slowest rank decide
+    in[0] = alpha;
+    in[1] = gamma;
+    MPI_Allreduce(in, out, 2, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    *alpha_out = out[0];
+    *gamma_out = out[1];
+    int k = (int)lround(sqrt(out[0] / (NX * out[1])));
+    if (k < 1) k = 1;
+    if (k > max_k) k = max_k;
+    return k;
+}
+
+int main(int argc, char **argv) {
+    double **u, **u_new, **tmp;
+    double *send_buf, *recv_buf;
+    int i, j, s, iter;
+    int rank, size;
+    int local_ny, start_y, end_y, min_ny;
+    double start_time, end_time, alpha = 0.0, gamma = 0.0;
+
+    // Initialize MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Divide the domain among processes (column-wise decomposition)
+    local_ny = (NY - 2) / size;
+    start_y = rank * local_ny + 1;
+    end_y = (rank == size - 1) ? (NY - 1) : (start_y + local_ny);
+    int nloc = end_y - start_y;
+    int left = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
+    int right = (rank < size - 1) ? rank + 1 : MPI_PROC_NULL;
+
+    // Ghosts come from one neighbour only, so k cannot exceed any rank's width
+    MPI_Allreduce(&nloc, &min_ny, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    int max_k = (min_ny < MAX_HALO) ? min_ny : MAX_HALO;
+    int k;
+    if (argc > 1) {
+        k = atoi(argv[1]);
+        if (k < 1 || k > min_ny) {
+            if (rank == 0) {
+                fprintf(stderr, "Halo width must be between 1 and %d\n", min_ny);
+            }
+            MPI_Finalize();
+            return 1;
+        }
+    } else if (size > 1) {
+        k = choose_halo_width(left, right, max_k, &alpha, &gamma);
+    } else {
+        k = 1;
+    }
+
+    // Start timing
+    start_time = MPI_Wtime();
+
+    // Local arrays: k ghost columns per side, owned columns [k, k + nloc);
+    // global j = start_y + j - k
+    int actual_ny = nloc + 2 * k;
+    u = (double **)malloc(NX * sizeof(double *));
+    u_new = (double **)malloc(NX * sizeof(double *));
+    for (i = 0; i < NX; i++) {
+        u[i] = (double *)malloc(actual_ny * sizeof(double));
+        u_new[i] = (double *)malloc(actual_ny * sizeof(double));
+    }
+    send_buf = (double *)malloc((size_t)NX * k * sizeof(double));
+    recv_buf = (double *)malloc((size_t)NX * k * sizeof(double));
+
+    // Initialize local grid (columns outside the global grid are never read)
+    #pragma omp parallel for private(i, j) collapse(2)
+    for (i = 0; i < NX; i++) {
+        for (j = 0; j < actual_ny; j++) {
+            int global_j = start_y + j - k;
+            u[i][j] = 0.0;
+            if (i == 0 || i == NX - 1 || global_j <= 0 || global_j >= NY - 1) {
+                u[i][j] = 100.0;
+            }
+            u_new[i][j] = u[i][j];
+        }
+    }
+
+    // Iterative solver: one exchange, then k local steps
+    double *block_diff = (double *)malloc(k * sizeof(double));
+    double *global_diff = (double *)malloc(k * sizeof(double));
+    int exchanges = 0, converged = -1;
+    for (iter = 0; iter < MAX_ITER && converged < 0; iter += k) {
+        exchange_halo(u, send_buf, recv_buf, k, k, k + nloc, left, right);
+        exchanges++;
+
+        int steps = (iter + k <= MAX_ITER) ? k : MAX_ITER - iter;
+        for (s = 0; s < steps; s++) {
+            // The valid region shrinks by one column per step; global edges stay fixed
+            int extend = k - 1 - s;
+            int jlo = (left != MPI_PROC_NULL) ? k - extend : k;
+            int jhi = (right != MPI_PROC_NULL) ? k + nloc + extend : k + nloc;
+            block_diff[s] = heat_sweep_plain(u, u_new, NULL, 0, 1, NX - 1, jlo, jhi);
+            tmp = u;
+            u = u_new;
+            u_new = tmp;
+        }
+        for (; s < k; s++) block_diff[s] = 0.0;
+
+        // One reduction per block; report the first step that converged
+        MPI_Allreduce(block_diff, global_diff, k, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        for (s = 0; s < steps; s++) {
+            if (global_diff[s] < TOLERANCE) {
+                converged = iter + s;
+                break;
+            }
+        }
+    }
+    if (rank == 0 && converged >= 0) {
+        printf("Converged after %d iterations.\n", converged);
+    }
+
+    // End timing
+    end_time = MPI_Wtime();
+
+    double local_sum = 0.0, sum;
+    for (i = 1; i < NX - 1; i++) {
+        for (j = k; j < k + nloc; j++) {
+            local_sum += u[i][j];
+        }
+    }
+    MPI_Reduce(&local_sum, &sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        if (alpha > 0.0) {
+            printf("Measured latency %.2f us, sweep cost %.2f ns/point\n", alpha * 1e6, gamma * 1e9);
+        }
+        printf("Halo width %d: %d exchanges\n", k, exchanges);
+        printf("Average interior temperature: %.6f\n", sum / ((double)(NX - 2) * (NY - 2)));
+        printf("Deep-halo execution time: %f seconds\n", end_time - start_time);
+    }
+
+    // Free memory
+    for (i = 0; i < NX; i++) {
+        free(u[i]);
+        free(u_new[i]);
+    }
+    free(u);
+    free(u_new);
+    free(send_buf);
+    free(recv_buf);
+    free(block_diff);
+    free(global_diff);
+
+    MPI_Finalize();
+    return 0;
+}
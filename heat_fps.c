@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+#include "libheat.h"
+#include "heat_fps.h"
+
+#define NX 500
+#define NY 500
+#define MAX_ITER 1000
+#define TOLERANCE 1e-6
+
+#define VALIDATE_TOL 1e-10          // Jacobi tolerance of the reference solution
+#define VALIDATE_MAX_ITER 2000000
+#define COARSE_FACTOR 4             // Coarse-grid spacing in fine cells
+
+// Direct steady-state solver: DST-I fast Poisson solve instead of Jacobi.
+//
+//   mpirun -np P ./heat_fps [solve|validate|coarse] [nx] [ny] [config]
+//
+// solve     direct solve, reports the Jacobi residual of the result (default)
+// validate  also runs libheat's Jacobi to VALIDATE_TOL and compares the fields;
+//           exits non-zero if they differ by more than validate_bound()
+// coarse    direct solve on a grid COARSE_FACTOR times coarser, interpolated
+//           into libheat as the starting guess of Jacobi, against a cold start
+//
+// The direct solver needs Dirichlet conditions on all four edges; a source
+// term from the config is supported.
+
+// Right-hand side of the interior equations of the local columns: the source
+// plus the Dirichlet values of neighbouring edge points
+static void build_rhs(const heat_config_t *cfg, const double *f, int nx, int ny,
+                      int j0, int j1, double *x) {
+    const int nloc = j1 - j0;
+    int i;
+
+    #pragma omp parallel for
+    for (i = 0; i < nx - 2; i++) {
+        for (int jl = 0; jl < nloc; jl++) {
+            int gi = i + 1, gj = j0 + jl + 1;
+            double v = (f != NULL) ? f[(long)gi * ny + gj] : 0.0;
+            if (gi == 1) v += cfg->value[EDGE_NORTH];
+            if (gi == nx - 2) v += cfg->value[EDGE_SOUTH];
+            if (gj == 1) v += cfg->value[EDGE_WEST];
+            if (gj == ny - 2) v += cfg->value[EDGE_EAST];
+            x[(long)i * nloc + jl] = v;
+        }
+    }
+}
+
+// Direct solve of the nx x ny problem; every rank gets the full grid, edges included
+static double *direct_solve(const heat_config_t *cfg, const double *f, int nx, int ny,
+                            double *seconds) {
+    const int m = nx - 2, n = ny - 2;
+    int rank, size;
+    heat_fps_t fps;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    heat_fps_init_mpi(&fps, m, n, MPI_COMM_WORLD);
+    const int nloc = fps.j1 - fps.j0;
+    double *x = (double *)malloc(((size_t)m * nloc + 1) * sizeof(double));
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime();
+    build_rhs(cfg, f, nx, ny, fps.j0, fps.j1, x);
+    heat_fps_solve(&fps, x, nloc);
+    *seconds = MPI_Wtime() - t0;
+
+    // Column blocks, one after another in rank order, then unpacked
+    int *counts = (int *)malloc(2 * size * sizeof(int)), *displs = counts + size;
+    for (int r = 0; r < size; r++) {
+        int j0 = heat_fps_block_start(n, size, r), j1 = heat_fps_block_start(n, size, r + 1);
+        counts[r] = m * (j1 - j0);
+        displs[r] = m * j0;
+    }
+    double *blocks = (double *)malloc(((size_t)m * n + 1) * sizeof(double));
+    MPI_Allgatherv(x, m * nloc, MPI_DOUBLE, blocks, counts, displs, MPI_DOUBLE, MPI_COMM_WORLD);
+
+    double *u = (double *)malloc((size_t)nx * ny * sizeof(double));
+    for (int i = 0; i < nx; i++) {
+        for (int j = 0; j < ny; j++) u[(long)i * ny + j] = heat_initial_value(cfg, i, j, nx, ny);
+    }
+    for (int r = 0; r < size; r++) {
+        int j0 = heat_fps_block_start(n, size, r), w = counts[r] / (m > 0 ? m : 1);
+        for (int i = 0; i < m; i++) {
+            memcpy(&u[(long)(i + 1) * ny + j0 + 1], &blocks[displs[r] + (long)i * w], w * sizeof(double));
+        }
+    }
+
+    free(blocks);
+    free(counts);
+    free(x);
+    heat_fps_free(&fps);
+    return u;
+}
+
+// Largest change one Jacobi sweep would make to u: zero at the exact fixed point
+static double jacobi_residual(const double *u, const double *f, int nx, int ny) {
+    double max_diff = 0.0;
+    int i;
+
+    #pragma omp parallel for reduction(max:max_diff)
+    for (i = 1; i < nx - 1; i++) {
+        for (int j = 1; j < ny - 1; j++) {
+            const double *c = u + (long)i * ny + j;
+            double sum = c[-ny] + c[ny] + c[-1] + c[1];
+            if (f != NULL) sum += f[(long)i * ny + j];
+            double diff = fabs(0.25 * sum - *c);
+            max_diff = (diff > max_diff) ? diff : max_diff;
+        }
+    }
+    return max_diff;
+}
+
+// Largest |field - u| over the points this rank owns in libheat's decomposition
+// Largest difference between the Jacobi field stopped at VALIDATE_TOL and the
+// exact discrete solution. Jacobi stops when one step changes u by at most
+// VALIDATE_TOL, and with spectral radius rho the remaining error is about
+// VALIDATE_TOL / (1 - rho); twice that, plus rounding of the direct solve,
+// is the accepted difference.
+static double validate_bound(int nx, int ny) {
+    const double pi = acos(-1.0);
+    double rho = 0.5 * (cos(pi / (nx - 1)) + cos(pi / (ny - 1)));
+    return 2.0 * VALIDATE_TOL / (1.0 - rho) + 1e-9;
+}
+
+static double compare_field(heat_solver_t *s, const double *u, int ny) {
+    heat_field_t fld = heat_field(s);
+    double max_diff = 0.0, global;
+    for (int i = 0; i < fld.nx; i++) {
+        for (int j = fld.owned_j0; j < fld.owned_j1; j++) {
+            double diff = fabs(fld.data[i * fld.stride + j] -
+                               u[(long)(fld.global_i0 + i) * ny + fld.global_j0 + j]);
+            if (diff > max_diff) max_diff = diff;
+        }
+    }
+    MPI_Allreduce(&max_diff, &global, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return global;
+}
+
+// Bilinear interpolation of the coarse grid into the interior points of the
+// solver's local block
+static void prolongate(heat_solver_t *s, const double *uc, int nxc, int nyc, int nx, int ny) {
+    heat_field_t fld = heat_field(s);
+    int i;
+
+    #pragma omp parallel for
+    for (i = 0; i < fld.nx; i++) {
+        int gi = fld.global_i0 + i;
+        if (gi <= 0 || gi >= nx - 1) continue;
+        double x = (double)gi * (nxc - 1) / (nx - 1);
+        int ic = (int)x < nxc - 2 ? (int)x : nxc - 2;
+        double wx = x - ic;
+        for (int j = 0; j < fld.ny; j++) {
+            int gj = fld.global_j0 + j;
+            if (gj <= 0 || gj >= ny - 1) continue;
+            double y = (double)gj * (nyc - 1) / (ny - 1);
+            int jc = (int)y < nyc - 2 ? (int)y : nyc - 2;
+            double wy = y - jc;
+            const double *c = uc + (long)ic * nyc + jc;
+            fld.data[i * fld.stride + j] = (1 - wx) * ((1 - wy) * c[0] + wy * c[1]) +
+                                           wx * ((1 - wy) * c[nyc] + wy * c[nyc + 1]);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *mode = "solve", *config = NULL;
+    int nx = NX, ny = NY, rank, size, a = 1;
+    heat_config_t cfg;
+    double *f = NULL, direct_time;
+
+    // Initialize MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc > a && (strcmp(argv[a], "solve") == 0 || strcmp(argv[a], "validate") == 0 ||
+                     strcmp(argv[a], "coarse") == 0)) {
+        mode = argv[a++];
+    }
+    if (argc > a) nx = atoi(argv[a++]);
+    if (argc > a) ny = atoi(argv[a++]);
+    if (argc > a) config = argv[a++];
+
+    heat_config_default(&cfg);
+    if (nx < 3 || ny < 3 || (config != NULL && heat_config_load(config, &cfg) != 0)) {
+        if (rank == 0) fprintf(stderr, "Usage: %s [solve|validate|coarse] [nx] [ny] [config]\n", argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+    for (int e = 0; e < NUM_EDGES; e++) {
+        if (cfg.type[e] != BC_DIRICHLET) {
+            if (rank == 0) fprintf(stderr, "Error: the direct solver needs Dirichlet edges (%s is %s)\n",
+                                   heat_edge_name(e), heat_bc_name(cfg.type[e]));
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    if (cfg.conductivity_file[0] != '\0') {
+        if (rank == 0) fprintf(stderr, "Error: the direct solver needs uniform conductivity\n");
+        MPI_Finalize();
+        return 1;
+    }
+    if (cfg.source_file[0] != '\0' && (f = heat_source_load(cfg.source_file, nx, ny)) == NULL) {
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (rank == 0) {
+        printf("Direct solve of %dx%d grid on %d ranks x %d threads\n",
+               nx, ny, size, omp_get_max_threads());
+    }
+
+    if (strcmp(mode, "coarse") == 0) {
+        // Coarse problem: same edges, source scaled by the squared spacing ratio
+        int nxc = (nx - 1) / COARSE_FACTOR + 1, nyc = (ny - 1) / COARSE_FACTOR + 1;
+        if (nxc < 3) nxc = 3;
+        if (nyc < 3) nyc = 3;
+        double *fc = NULL;
+        if (f != NULL) {
+            double hx = (double)(nx - 1) / (nxc - 1), hy = (double)(ny - 1) / (nyc - 1);
+            fc = (double *)malloc((size_t)nxc * nyc * sizeof(double));
+            for (int i = 0; i < nxc; i++) {
+                for (int j = 0; j < nyc; j++) {
+                    fc[(long)i * nyc + j] = hx * hy * f[lround(i * hx) * ny + lround(j * hy)];
+                }
+            }
+        }
+        double *uc = direct_solve(&cfg, fc, nxc, nyc, &direct_time);
+
+        heat_options_t opts;
+        heat_options_default(&opts, nx, ny);
+        opts.config = cfg;
+        opts.source = f;
+        heat_solver_t *s = heat_create_mpi(&opts, MPI_COMM_WORLD);
+        if (s == NULL) {
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+
+        double t0 = MPI_Wtime();
+        prolongate(s, uc, nxc, nyc, nx, ny);
+        int warm = heat_solve(s, VALIDATE_MAX_ITER, TOLERANCE);
+        double warm_time = MPI_Wtime() - t0;
+        double warm_avg = heat_interior_average(s);
+
+        heat_reset(s, &cfg);
+        t0 = MPI_Wtime();
+        int cold = heat_solve(s, VALIDATE_MAX_ITER, TOLERANCE);
+        double cold_time = MPI_Wtime() - t0;
+
+        if (rank == 0) {
+            printf("Coarse direct solve (%dx%d): %f seconds\n", nxc, nyc, direct_time);
+            printf("Coarse-grid start: converged after %d iterations, %f seconds\n", warm, warm_time);
+            printf("Cold start: converged after %d iterations, %f seconds\n", cold, cold_time);
+            printf("Average interior temperature: %.12f\n", warm_avg);
+        }
+        heat_destroy(s);
+        free(uc);
+        free(fc);
+        free(f);
+        MPI_Finalize();
+        return 0;
+    }
+
+    double *u = direct_solve(&cfg, f, nx, ny, &direct_time);
+    if (rank == 0) {
+        double sum = 0.0;
+        for (int i = 1; i < nx - 1; i++) {
+            for (int j = 1; j < ny - 1; j++) sum += u[(long)i * ny + j];
+        }
+        printf("Jacobi residual of direct solution: %.3e\n", jacobi_residual(u, f, nx, ny));
+        printf("Average interior temperature: %.12f\n", sum / ((double)(nx - 2) * (ny - 2)));
+        printf("Direct solve execution time: %f seconds\n", direct_time);
+    }
+
+    if (strcmp(mode, "validate") == 0) {
+        heat_options_t opts;
+        heat_options_default(&opts, nx, ny);
+        opts.config = cfg;
+        opts.source = f;
+        heat_solver_t *s = heat_create_mpi(&opts, MPI_COMM_WORLD);
+        if (s == NULL) {
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        double t0 = MPI_Wtime();
+        int iter = heat_solve(s, VALIDATE_MAX_ITER, VALIDATE_TOL);
+        double jacobi_time = MPI_Wtime() - t0;
+        double max_diff = compare_field(s, u, ny);
+        double bound = validate_bound(nx, ny);
+        if (rank == 0) {
+            if (iter >= 0) {
+                printf("Jacobi converged after %d iterations (tolerance %g).\n", iter, VALIDATE_TOL);
+            } else {
+                printf("Jacobi did not converge in %d iterations.\n", VALIDATE_MAX_ITER);
+            }
+            printf("Jacobi execution time: %f seconds\n", jacobi_time);
+            printf("Max |u_jacobi - u_direct|: %.3e (bound %.3e): %s\n", max_diff, bound,
+                   (iter >= 0 && max_diff <= bound) ? "PASS" : "FAIL");
+        }
+        heat_destroy(s);
+        if (iter < 0 || max_diff > bound) {
+            free(u);
+            free(f);
+            MPI_Finalize();
+            return 1;
+        }
+    }
+
+    free(u);
+    free(f);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,487 @@
+#ifndef HEAT_FPS_H
+#define HEAT_FPS_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Fast Poisson solver for the 5-point operator with Dirichlet edges.
+//
+// Solves 4 u[i][j] - u[i-1][j] - u[i+1][j] - u[i][j-1] - u[i][j+1] = b[i][j]
+// on an m x n interior, i.e. the fixed point the Jacobi programs iterate
+// towards, directly. The operator is diagonal in the basis
+// sin(pi k i / (m+1)) sin(pi l j / (n+1)), so a solve is a discrete sine
+// transform (DST-I) along each dimension, a division by the eigenvalues and
+// the same transforms again: O(m n log(m n)) and no iteration count.
+//
+// A DST-I of length N is read off an FFT of length 2(N+1) of the odd
+// extension, with two real lines packed into one complex FFT. The FFT is a
+// mixed-radix Stockham transform (radix 4, 2 and primes up to 13); lengths
+// with a larger prime factor go through Bluestein's algorithm on a
+// power-of-two FFT. Transforms run on batches of lines that are contiguous in
+// memory, so each butterfly is a SIMD loop across lines, and the batches are
+// shared among OpenMP threads.
+//
+// Under MPI the interior is split by columns as in heat_parallel. A solve
+// transforms along columns locally, transposes into row blocks with
+// MPI_Alltoallv, transforms along rows and transposes back. heat_fps_solve
+// applies the inverse operator to any right-hand side; heat_fps uses it for
+// the coarse-grid starting guess.
+
+#define HEAT_FFT_BATCH 16           // Complex lines per batch (32 real lines)
+#define HEAT_FFT_MAX_RADIX 13       // Larger prime factors use Bluestein
+
+typedef struct heat_fft {
+    int n;
+    int nf, factor[32];
+    double *tw_re, *tw_im;          // Stage twiddles w^(j k), stages concatenated
+    struct heat_fft *inner;         // Bluestein: power-of-two FFT of length L >= 2n - 1
+    double *chirp_re, *chirp_im;    // exp(-i pi k^2 / n)
+    double *kern_re, *kern_im;      // FFT of the conjugate chirp, scaled by 1 / L
+} heat_fft_t;
+
+// Scratch doubles per batch line needed by heat_fft_exec
+static inline long heat_fft_work(const heat_fft_t *p) {
+    return (p->inner != NULL) ? 4L * p->inner->n : 2L * p->n;
+}
+
+// One Stockham stage of radix r over sequences of length len at stride s:
+// y[q + s (r j + k)] = w^(j k) sum_t x[q + s (j + t m)] e^(-2 pi i t k / r),
+// with m = len / r and w = e^(-2 pi i / len). Element e of a sequence is the
+// batch vector [e * nb, e * nb + nb).
+static inline void heat_fft_stage(int r, int len, int s, const double *twr, const double *twi,
+                                  const double *xr, const double *xi, double *yr, double *yi, int nb) {
+    const int m = len / r;
+    double root_re[HEAT_FFT_MAX_RADIX], root_im[HEAT_FFT_MAX_RADIX];
+
+    if (r != 2 && r != 4) {
+        for (int t = 0; t < r; t++) {
+            root_re[t] = cos(-2.0 * M_PI * t / r);
+            root_im[t] = sin(-2.0 * M_PI * t / r);
+        }
+    }
+    for (int j = 0; j < m; j++) {
+        const double *wr = twr + (long)j * (r - 1), *wi = twi + (long)j * (r - 1);
+        for (int q = 0; q < s; q++) {
+            const long in = (long)(q + s * j) * nb, step = (long)s * m * nb;
+            const long out = (long)(q + s * r * j) * nb, ostep = (long)s * nb;
+            const double *ar = xr + in, *ai = xi + in;
+            double *br = yr + out, *bi = yi + out;
+
+            if (r == 2) {
+                #pragma omp simd
+                for (int b = 0; b < nb; b++) {
+                    double dr = ar[b] - ar[step + b], di = ai[b] - ai[step + b];
+                    br[b] = ar[b] + ar[step + b];
+                    bi[b] = ai[b] + ai[step + b];
+                    br[ostep + b] = dr * wr[0] - di * wi[0];
+                    bi[ostep + b] = dr * wi[0] + di * wr[0];
+                }
+            } else if (r == 4) {
+                #pragma omp simd
+                for (int b = 0; b < nb; b++) {
+                    double t0r = ar[b] + ar[2 * step + b], t0i = ai[b] + ai[2 * step + b];
+                    double t1r = ar[b] - ar[2 * step + b], t1i = ai[b] - ai[2 * step + b];
+                    double t2r = ar[step + b] + ar[3 * step + b], t2i = ai[step + b] + ai[3 * step + b];
+                    // -i (a1 - a3)
+                    double t3r = ai[step + b] - ai[3 * step + b], t3i = ar[3 * step + b] - ar[step + b];
+                    double y1r = t1r + t3r, y1i = t1i + t3i;
+                    double y2r = t0r - t2r, y2i = t0i - t2i;
+                    double y3r = t1r - t3r, y3i = t1i - t3i;
+                    br[b] = t0r + t2r;
+                    bi[b] = t0i + t2i;
+                    br[ostep + b] = y1r * wr[0] - y1i * wi[0];
+                    bi[ostep + b] = y1r * wi[0] + y1i * wr[0];
+                    br[2 * ostep + b] = y2r * wr[1] - y2i * wi[1];
+                    bi[2 * ostep + b] = y2r * wi[1] + y2i * wr[1];
+                    br[3 * ostep + b] = y3r * wr[2] - y3i * wi[2];
+                    bi[3 * ostep + b] = y3r * wi[2] + y3i * wr[2];
+                }
+            } else {
+                // Odd prime radix: direct r-point DFT
+                for (int k = 0; k < r; k++) {
+                    double accr[HEAT_FFT_BATCH], acci[HEAT_FFT_BATCH];
+                    #pragma omp simd
+                    for (int b = 0; b < nb; b++) {
+                        accr[b] = ar[b];
+                        acci[b] = ai[b];
+                    }
+                    for (int t = 1; t < r; t++) {
+                        const double cr = root_re[(t * k) % r], ci = root_im[(t * k) % r];
+                        const double *tr = ar + t * step, *ti = ai + t * step;
+                        #pragma omp simd
+                        for (int b = 0; b < nb; b++) {
+                            accr[b] += tr[b] * cr - ti[b] * ci;
+                            acci[b] += tr[b] * ci + ti[b] * cr;
+                        }
+                    }
+                    const double cr = (k > 0) ? wr[k - 1] : 1.0, ci = (k > 0) ? wi[k - 1] : 0.0;
+                    #pragma omp simd
+                    for (int b = 0; b < nb; b++) {
+                        br[k * ostep + b] = accr[b] * cr - acci[b] * ci;
+                        bi[k * ostep + b] = accr[b] * ci + acci[b] * cr;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// In-place forward FFT of nb <= HEAT_FFT_BATCH lines stored as re/im[e * nb + b];
+// work holds heat_fft_work(p) * nb doubles
+static inline void heat_fft_exec(const heat_fft_t *p, double *re, double *im, int nb, double *work) {
+    const int n = p->n;
+
+    if (p->inner != NULL) {
+        // Bluestein: X_k = c_k * (a conv conj(c))_k with a_k = x_k c_k
+        const int L = p->inner->n;
+        double *ar = work, *ai = work + (long)L * nb, *rest = work + 2L * L * nb;
+        for (int k = 0; k < n; k++) {
+            const double cr = p->chirp_re[k], ci = p->chirp_im[k];
+            #pragma omp simd
+            for (int b = 0; b < nb; b++) {
+                double xr = re[(long)k * nb + b], xi = im[(long)k * nb + b];
+                ar[(long)k * nb + b] = xr * cr - xi * ci;
+                ai[(long)k * nb + b] = xr * ci + xi * cr;
+            }
+        }
+        memset(ar + (long)n * nb, 0, (size_t)(L - n) * nb * sizeof(double));
+        memset(ai + (long)n * nb, 0, (size_t)(L - n) * nb * sizeof(double));
+        heat_fft_exec(p->inner, ar, ai, nb, rest);
+
+        // Multiply by the kernel and conjugate: the next forward FFT is then an inverse
+        for (int k = 0; k < L; k++) {
+            const double kr = p->kern_re[k], ki = p->kern_im[k];
+            #pragma omp simd
+            for (int b = 0; b < nb; b++) {
+                double xr = ar[(long)k * nb + b], xi = ai[(long)k * nb + b];
+                ar[(long)k * nb + b] = xr * kr - xi * ki;
+                ai[(long)k * nb + b] = -(xr * ki + xi * kr);
+            }
+        }
+        heat_fft_exec(p->inner, ar, ai, nb, rest);
+
+        for (int k = 0; k < n; k++) {
+            const double cr = p->chirp_re[k], ci = p->chirp_im[k];
+            #pragma omp simd
+            for (int b = 0; b < nb; b++) {
+                double zr = ar[(long)k * nb + b], zi = -ai[(long)k * nb + b];
+                re[(long)k * nb + b] = zr * cr - zi * ci;
+                im[(long)k * nb + b] = zr * ci + zi * cr;
+            }
+        }
+        return;
+    }
+
+    double *xr = re, *xi = im, *yr = work, *yi = work + (long)n * nb;
+    const double *twr = p->tw_re, *twi = p->tw_im;
+    int len = n, s = 1;
+    for (int f = 0; f < p->nf; f++) {
+        const int r = p->factor[f];
+        heat_fft_stage(r, len, s, twr, twi, xr, xi, yr, yi, nb);
+        twr += (long)(len / r) * (r - 1);
+        twi += (long)(len / r) * (r - 1);
+        double *t = xr; xr = yr; yr = t;
+        t = xi; xi = yi; yi = t;
+        s *= r;
+        len /= r;
+    }
+    if (xr != re) {
+        memcpy(re, xr, (size_t)n * nb * sizeof(double));
+        memcpy(im, xi, (size_t)n * nb * sizeof(double));
+    }
+}
+
+static inline heat_fft_t *heat_fft_plan(int n) {
+    heat_fft_t *p = (heat_fft_t *)calloc(1, sizeof(heat_fft_t));
+    int rest = n;
+
+    p->n = n;
+    while (rest % 4 == 0) { p->factor[p->nf++] = 4; rest /= 4; }
+    if (rest % 2 == 0) { p->factor[p->nf++] = 2; rest /= 2; }
+    for (int f = 3; f <= HEAT_FFT_MAX_RADIX; f += 2) {
+        while (rest % f == 0) { p->factor[p->nf++] = f; rest /= f; }
+    }
+
+    if (rest > 1) {
+        // Large prime factor: Bluestein on a power-of-two length
+        int L = 1;
+        while (L < 2 * n - 1) L *= 2;
+        p->nf = 0;
+        p->inner = heat_fft_plan(L);
+        p->chirp_re = (double *)malloc(n * sizeof(double));
+        p->chirp_im = (double *)malloc(n * sizeof(double));
+        p->kern_re = (double *)calloc(L, sizeof(double));
+        p->kern_im = (double *)calloc(L, sizeof(double));
+        for (int k = 0; k < n; k++) {
+            double angle = M_PI * (double)(((long)k * k) % (2L * n)) / n;
+            p->chirp_re[k] = cos(angle);
+            p->chirp_im[k] = -sin(angle);
+            p->kern_re[k] = cos(angle);
+            p->kern_im[k] = sin(angle);
+            if (k > 0) {
+                p->kern_re[L - k] = cos(angle);
+                p->kern_im[L - k] = sin(angle);
+            }
+        }
+        double *work = (double *)malloc(heat_fft_work(p->inner) * sizeof(double));
+        heat_fft_exec(p->inner, p->kern_re, p->kern_im, 1, work);
+        free(work);
+        for (int k = 0; k < L; k++) {
+            p->kern_re[k] /= L;
+            p->kern_im[k] /= L;
+        }
+        return p;
+    }
+
+    // Twiddles of every stage: w^(j k) for j < len / r, 1 <= k < r
+    long total = 0;
+    for (int f = 0, len = n; f < p->nf; len /= p->factor[f++]) {
+        total += (long)(len / p->factor[f]) * (p->factor[f] - 1);
+    }
+    p->tw_re = (double *)malloc((total + 1) * sizeof(double));
+    p->tw_im = (double *)malloc((total + 1) * sizeof(double));
+    long t = 0;
+    for (int f = 0, len = n; f < p->nf; len /= p->factor[f++]) {
+        const int r = p->factor[f];
+        for (int j = 0; j < len / r; j++) {
+            for (int k = 1; k < r; k++, t++) {
+                p->tw_re[t] = cos(-2.0 * M_PI * (double)j * k / len);
+                p->tw_im[t] = sin(-2.0 * M_PI * (double)j * k / len);
+            }
+        }
+    }
+    return p;
+}
+
+static inline void heat_fft_free(heat_fft_t *p) {
+    if (p == NULL) return;
+    heat_fft_free(p->inner);
+    free(p->tw_re);
+    free(p->tw_im);
+    free(p->chirp_re);
+    free(p->chirp_im);
+    free(p->kern_re);
+    free(p->kern_im);
+    free(p);
+}
+
+// Unnormalized DST-I of length N = fft->n / 2 - 1, in place along the slow
+// index of x: X[k][l] = sum_i x[i][l] sin(pi (i+1) (k+1) / (N+1)) with
+// x[i][l] = x[i * ld + l] for lines l < nlines. Applying it twice scales by (N+1)/2.
+static inline void heat_dst1_lines(const heat_fft_t *fft, double *x, long ld, int nlines) {
+    const int M = fft->n, N = M / 2 - 1, span = 2 * HEAT_FFT_BATCH;
+    const int nchunks = (nlines + span - 1) / span;
+
+    #pragma omp parallel
+    {
+        double *re = (double *)malloc((size_t)M * HEAT_FFT_BATCH * sizeof(double));
+        double *im = (double *)malloc((size_t)M * HEAT_FFT_BATCH * sizeof(double));
+        double *work = (double *)malloc(heat_fft_work(fft) * HEAT_FFT_BATCH * sizeof(double));
+
+        #pragma omp for schedule(static)
+        for (int c = 0; c < nchunks; c++) {
+            const int l0 = c * span, nl = (nlines - l0 < span) ? nlines - l0 : span;
+            const int nb = (nl + 1) / 2, odd = nl & 1;
+
+            // Odd extension [0, x, 0, -reverse(x)]: even lines real, odd lines imaginary
+            memset(re, 0, (size_t)nb * sizeof(double));
+            memset(im, 0, (size_t)nb * sizeof(double));
+            memset(re + (long)(N + 1) * nb, 0, (size_t)nb * sizeof(double));
+            memset(im + (long)(N + 1) * nb, 0, (size_t)nb * sizeof(double));
+            for (int k = 0; k < N; k++) {
+                const double *row = x + k * ld + l0;
+                double *pr = re + (long)(k + 1) * nb, *pi = im + (long)(k + 1) * nb;
+                double *nr = re + (long)(M - 1 - k) * nb, *ni = im + (long)(M - 1 - k) * nb;
+                #pragma omp simd
+                for (int b = 0; b < nb - odd; b++) {
+                    pr[b] = row[2 * b];
+                    pi[b] = row[2 * b + 1];
+                    nr[b] = -row[2 * b];
+                    ni[b] = -row[2 * b + 1];
+                }
+                if (odd) {
+                    pr[nb - 1] = row[nl - 1];
+                    nr[nb - 1] = -row[nl - 1];
+                    pi[nb - 1] = ni[nb - 1] = 0.0;
+                }
+            }
+
+            heat_fft_exec(fft, re, im, nb, work);
+
+            // Y = A + iB with A = -2i S_a and B = -2i S_b
+            for (int k = 0; k < N; k++) {
+                double *row = x + k * ld + l0;
+                const double *pr = re + (long)(k + 1) * nb, *pi = im + (long)(k + 1) * nb;
+                #pragma omp simd
+                for (int b = 0; b < nb - odd; b++) {
+                    row[2 * b] = -0.5 * pi[b];
+                    row[2 * b + 1] = 0.5 * pr[b];
+                }
+                if (odd) {
+                    row[nl - 1] = -0.5 * pi[nb - 1];
+                }
+            }
+        }
+        free(re);
+        free(im);
+        free(work);
+    }
+}
+
+typedef struct {
+    int m, n;                   // Interior rows and columns
+    int rank, size;
+    int j0, j1;                 // Columns of this rank in the column layout
+    int i0, i1;                 // Rows of this rank in the row layout
+    heat_fft_t *fft_m, *fft_n;  // FFTs of length 2(m+1) and 2(n+1)
+    double *lambda, *mu;        // Eigenvalues of the 1D operators
+    double *t;                  // Row layout, transposed: t[j * (i1 - i0) + i - i0]
+    double *buf;                // Packed blocks of the column layout
+#ifdef MPI_VERSION
+    MPI_Comm comm;
+    int *col_counts, *col_displs;   // Blocks in buf, by rank
+    int *row_counts, *row_displs;   // Blocks in t, by rank
+#endif
+} heat_fps_t;
+
+// Block split of len lines over size ranks as in heat_parallel: equal blocks,
+// remainder on the last rank
+static inline int heat_fps_block_start(int len, int size, int r) {
+    return (r == size) ? len : r * (len / size);
+}
+
+static inline void heat_fps_setup(heat_fps_t *p, int m, int n, int rank, int size) {
+    memset(p, 0, sizeof(*p));
+    p->m = m;
+    p->n = n;
+    p->rank = rank;
+    p->size = size;
+    p->j0 = heat_fps_block_start(n, size, rank);
+    p->j1 = heat_fps_block_start(n, size, rank + 1);
+    p->i0 = heat_fps_block_start(m, size, rank);
+    p->i1 = heat_fps_block_start(m, size, rank + 1);
+    p->fft_m = heat_fft_plan(2 * (m + 1));
+    p->fft_n = heat_fft_plan(2 * (n + 1));
+    p->lambda = (double *)malloc(m * sizeof(double));
+    p->mu = (double *)malloc(n * sizeof(double));
+    for (int k = 0; k < m; k++) p->lambda[k] = 2.0 - 2.0 * cos(M_PI * (k + 1) / (m + 1));
+    for (int k = 0; k < n; k++) p->mu[k] = 2.0 - 2.0 * cos(M_PI * (k + 1) / (n + 1));
+    p->t = (double *)malloc(((size_t)(p->i1 - p->i0) * n + 1) * sizeof(double));
+    p->buf = (double *)malloc(((size_t)m * (p->j1 - p->j0) + 1) * sizeof(double));
+}
+
+// Serial solver for an m x n interior
+static inline void heat_fps_init(heat_fps_t *p, int m, int n) {
+    heat_fps_setup(p, m, n, 0, 1);
+}
+
+#ifdef MPI_VERSION
+// Solver over the ranks of comm; this rank holds interior columns [p->j0, p->j1)
+static inline void heat_fps_init_mpi(heat_fps_t *p, int m, int n, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    heat_fps_setup(p, m, n, rank, size);
+    p->comm = comm;
+    p->col_counts = (int *)malloc(4 * size * sizeof(int));
+    p->col_displs = p->col_counts + size;
+    p->row_counts = p->col_counts + 2 * size;
+    p->row_displs = p->col_counts + 3 * size;
+    for (int r = 0; r < size; r++) {
+        int i0 = heat_fps_block_start(m, size, r), i1 = heat_fps_block_start(m, size, r + 1);
+        int j0 = heat_fps_block_start(n, size, r), j1 = heat_fps_block_start(n, size, r + 1);
+        p->col_counts[r] = (i1 - i0) * (p->j1 - p->j0);
+        p->col_displs[r] = i0 * (p->j1 - p->j0);
+        p->row_counts[r] = (j1 - j0) * (p->i1 - p->i0);
+        p->row_displs[r] = j0 * (p->i1 - p->i0);
+    }
+}
+#endif
+
+// Column layout <-> row layout. buf holds, for each rank r in turn, the rows
+// of r's row block of this rank's columns, column-major; that is exactly the
+// piece of r's transposed row layout, so the exchange needs no unpacking.
+static inline void heat_fps_transpose(heat_fps_t *p, double *x, long ld, int forward) {
+#ifdef MPI_VERSION
+    if (p->size > 1) {
+        const int nloc = p->j1 - p->j0;
+        double *buf = p->buf;
+        if (forward) {
+            #pragma omp parallel for schedule(static)
+            for (int r = 0; r < p->size; r++) {
+                int i0 = heat_fps_block_start(p->m, p->size, r), i1 = heat_fps_block_start(p->m, p->size, r + 1);
+                double *dst = buf + (long)i0 * nloc;
+                for (int jl = 0; jl < nloc; jl++) {
+                    for (int i = i0; i < i1; i++) dst[(long)jl * (i1 - i0) + i - i0] = x[i * ld + jl];
+                }
+            }
+            MPI_Alltoallv(buf, p->col_counts, p->col_displs, MPI_DOUBLE,
+                          p->t, p->row_counts, p->row_displs, MPI_DOUBLE, p->comm);
+        } else {
+            MPI_Alltoallv(p->t, p->row_counts, p->row_displs, MPI_DOUBLE,
+                          buf, p->col_counts, p->col_displs, MPI_DOUBLE, p->comm);
+            #pragma omp parallel for schedule(static)
+            for (int r = 0; r < p->size; r++) {
+                int i0 = heat_fps_block_start(p->m, p->size, r), i1 = heat_fps_block_start(p->m, p->size, r + 1);
+                const double *src = buf + (long)i0 * nloc;
+                for (int jl = 0; jl < nloc; jl++) {
+                    for (int i = i0; i < i1; i++) x[i * ld + jl] = src[(long)jl * (i1 - i0) + i - i0];
+                }
+            }
+        }
+        return;
+    }
+#endif
+    // Single block: a local transpose
+    #pragma omp parallel for schedule(static)
+    for (int j = 0; j < p->n; j++) {
+        double *col = p->t + (long)j * p->m;
+        if (forward) {
+            for (int i = 0; i < p->m; i++) col[i] = x[i * ld + j];
+        } else {
+            for (int i = 0; i < p->m; i++) x[i * ld + j] = col[i];
+        }
+    }
+}
+
+// Replace the right-hand side b with the solution u, in place. x[i * ld + jl]
+// is interior row i (0 <= i < m) of local column jl, i.e. interior column
+// p->j0 + jl. Collective under MPI.
+static inline void heat_fps_solve(heat_fps_t *p, double *x, long ld) {
+    const int nloc = p->j1 - p->j0, mloc = p->i1 - p->i0;
+    const double scale = 4.0 / ((p->m + 1.0) * (p->n + 1.0));
+
+    heat_dst1_lines(p->fft_m, x, ld, nloc);
+    heat_fps_transpose(p, x, ld, 1);
+    heat_dst1_lines(p->fft_n, p->t, mloc, mloc);
+
+    #pragma omp parallel for schedule(static)
+    for (int j = 0; j < p->n; j++) {
+        double *row = p->t + (long)j * mloc;
+        const double *lambda = p->lambda + p->i0;
+        const double mu = p->mu[j];
+        #pragma omp simd
+        for (int il = 0; il < mloc; il++) {
+            row[il] *= scale / (lambda[il] + mu);
+        }
+    }
+
+    heat_dst1_lines(p->fft_n, p->t, mloc, mloc);
+    heat_fps_transpose(p, x, ld, 0);
+    heat_dst1_lines(p->fft_m, x, ld, nloc);
+}
+
+static inline void heat_fps_free(heat_fps_t *p) {
+    heat_fft_free(p->fft_m);
+    heat_fft_free(p->fft_n);
+    free(p->lambda);
+    free(p->mu);
+    free(p->t);
+    free(p->buf);
+#ifdef MPI_VERSION
+    free(p->col_counts);
+#endif
+}
+
+#endif
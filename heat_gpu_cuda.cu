@@ -9,7 +9,9 @@
 #define TOLERANCE 1e-6
 #define BLOCK_SIZE 16
 
-// CUDA kernel for heat equation update
+// CUDA kernel for heat equation update. One thread per point, so it keeps its
+// own copy of the 5-point update; the host-side row kernel of heat_stencil.h
+// (double ** rows, OpenMP pragmas) does not compile as device code.
 __global__ void heat_kernel(double *u, double *u_new, int nx, int ny, double *max_diff_device) {
     int i = blockIdx.x * blockDim.x + threadIdx.x + 1;
     int j = blockIdx.y * blockDim.y + threadIdx.y + 1;
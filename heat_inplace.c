@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "heat_stencil.h"
+
+#define NX 500
+#define NY 500
+#define MAX_ITER 1000
+#define TOLERANCE 1e-6
+
+// Hybrid MPI+OpenMP Jacobi with a single grid updated in place.
+//
+// Each thread owns a strip of rows [r0, r1). Before anyone writes, it copies
+// the old rows just outside its strip (r0 - 1 and r1, owned by the neighbouring
+// threads or fixed boundary); after a barrier it walks its strip top to bottom
+// keeping the old copy of the previous row and of the row being overwritten in
+// two rolling line buffers. Rank seams need nothing extra: ghost columns are
+// received before the sweep and never written. Every update reads exactly the
+// old values the two-buffer kernel reads, in the same order, so the iterates
+// are bit-identical to heat_parallel while the grid is stored once.
+
+int main(int argc, char **argv) {
+    double **u;
+    double *send_buf, *recv_buf, *lines;
+    int i, iter;
+    double max_diff, global_max_diff;
+    int rank, size;
+    int local_ny, start_y, end_y;
+    double start_time, end_time;
+
+    // Initialize MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Start timing
+    start_time = MPI_Wtime();
+
+    // Divide the domain among processes (column-wise decomposition)
+    local_ny = (NY - 2) / size;
+    start_y = rank * local_ny + 1;
+    end_y = (rank == size - 1) ? (NY - 1) : (start_y + local_ny);
+
+    // One grid with ghost columns, plus three lines per thread
+    int actual_ny = end_y - start_y + 2;
+    int max_threads = omp_get_max_threads();
+    u = (double **)malloc(NX * sizeof(double *));
+    for (i = 0; i < NX; i++) {
+        u[i] = (double *)malloc(actual_ny * sizeof(double));
+    }
+    lines = (double *)malloc((size_t)max_threads * 3 * actual_ny * sizeof(double));
+    send_buf = (double *)malloc(NX * sizeof(double));
+    recv_buf = (double *)malloc(NX * sizeof(double));
+    int left = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
+    int right = (rank < size - 1) ? rank + 1 : MPI_PROC_NULL;
+
+    // Initialize local grid
+    #pragma omp parallel for private(i)
+    for (i = 0; i < NX; i++) {
+        for (int j = 0; j < actual_ny; j++) {
+            int global_j = start_y + j - 1;
+            u[i][j] = 0.0;
+            if (i == 0 || i == NX - 1 || global_j == 0 || global_j == NY - 1) {
+                u[i][j] = 100.0;
+            }
+        }
+    }
+
+    // Iterative solver
+    for (iter = 0; iter < MAX_ITER; iter++) {
+        // Exchange ghost columns (packed, one message per neighbour)
+        for (i = 0; i < NX; i++) send_buf[i] = u[i][1];
+        MPI_Sendrecv(send_buf, NX, MPI_DOUBLE, left, 0,
+                     recv_buf, NX, MPI_DOUBLE, right, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        if (right != MPI_PROC_NULL) {
+            for (i = 0; i < NX; i++) u[i][actual_ny - 1] = recv_buf[i];
+        }
+        for (i = 0; i < NX; i++) send_buf[i] = u[i][actual_ny - 2];
+        MPI_Sendrecv(send_buf, NX, MPI_DOUBLE, right, 1,
+                     recv_buf, NX, MPI_DOUBLE, left, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        if (left != MPI_PROC_NULL) {
+            for (i = 0; i < NX; i++) u[i][0] = recv_buf[i];
+        }
+
+        // In-place sweep of rows 1..NX-2
+        max_diff = 0.0;
+        #pragma omp parallel reduction(max:max_diff)
+        {
+            int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();
+            int r0 = 1 + (int)((long)(NX - 2) * tid / nthreads);
+            int r1 = 1 + (int)((long)(NX - 2) * (tid + 1) / nthreads);
+            double *prev = lines + (size_t)tid * 3 * actual_ny;   // Old row i - 1
+            double *save = prev + actual_ny;                      // Old row i
+            double *below = save + actual_ny;                     // Old row r1 (seam)
+            size_t bytes = actual_ny * sizeof(double);
+
+            // Seam rows must be copied before the neighbouring strips change them
+            if (r0 < r1) {
+                memcpy(prev, u[r0 - 1], bytes);
+                memcpy(below, u[r1], bytes);
+            }
+            #pragma omp barrier
+
+            for (int row = r0; row < r1; row++) {
+                double *next = (row + 1 == r1) ? below : u[row + 1];
+                double *cur = u[row];
+                memcpy(save, cur, bytes);
+
+                // Three-row window of old values around the row written in place
+                double *win[3] = { prev, save, next }, *out[3] = { NULL, cur, NULL };
+                double diff = stencil_5pt_row(win, out, NULL, 0, 1, 1, actual_ny - 1, 0);
+                if (diff > max_diff) {
+                    max_diff = diff;
+                }
+                double *tmp = prev;
+                prev = save;
+                save = tmp;
+            }
+        }
+
+        // Global reduction to find maximum difference
+        MPI_Allreduce(&max_diff, &global_max_diff, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+        // Check for convergence
+        if (global_max_diff < TOLERANCE) {
+            if (rank == 0) {
+                printf("Converged after %d iterations.\n", iter);
+            }
+            break;
+        }
+    }
+
+    // End timing
+    end_time = MPI_Wtime();
+
+    double local_sum = 0.0, sum, bytes[2], total[2];
+    for (i = 1; i < NX - 1; i++) {
+        for (int j = 1; j < actual_ny - 1; j++) {
+            local_sum += u[i][j];
+        }
+    }
+    bytes[0] = (double)NX * actual_ny * sizeof(double) + (double)max_threads * 3 * actual_ny * sizeof(double);
+    bytes[1] = 2.0 * NX * actual_ny * sizeof(double);
+    MPI_Reduce(&local_sum, &sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(bytes, total, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        printf("Grid memory: %.2f MB (two-buffer Jacobi: %.2f MB)\n", total[0] / 1e6, total[1] / 1e6);
+        printf("Average interior temperature: %.6f\n", sum / ((double)(NX - 2) * (NY - 2)));
+        printf("In-place execution time: %f seconds\n", end_time - start_time);
+    }
+
+    // Free memory
+    for (i = 0; i < NX; i++) {
+        free(u[i]);
+    }
+    free(u);
+    free(lines);
+    free(send_buf);
+    free(recv_buf);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,271 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "heat_stencil.h"
+
+#define NX 500
+#define NY 500
+#define MAX_ITER 1000
+#define TOLERANCE 1e-6
+
+// Tile size of the activity map
+#define TILE_X 32
+#define TILE_Y 32
+
+// Tiles whose change (and whose neighbours' change) is at most
+// ACTIVITY_FRACTION * TOLERANCE are skipped. With 0 only tiles whose
+// inputs are bit-for-bit unchanged are skipped and the result is exact.
+#ifndef ACTIVITY_FRACTION
+#define ACTIVITY_FRACTION 0.1
+#endif
+
+// Hybrid MPI+OpenMP solver with activity-tracked lazy sweeps.
+//
+// The local interior is split into TILE_X x TILE_Y tiles. Each tile keeps the
+// maximum change of its last sweep. A tile is recomputed only if its own change
+// or a neighbour's change (including the ghost column) is above the activity
+// threshold. Skipped tiles keep their values and record zero change, so a tile
+// wakes up again as soon as a neighbour moves.
+//
+// Halo messages carry data only when the edge column has moved by more than
+// the threshold since the last message sent. A suppressed halo goes out as a
+// zero-length message, so every rank posts the same receives each iteration
+// and learns from the received count whether its ghost column changed. The
+// only collective left is the fixed-size reduction of max_diff.
+
+int main(int argc, char **argv) {
+    double **u, **u_new;
+    double *last_left, *last_right, *recv_left, *recv_right;
+    int i, j, iter;
+    double max_diff, global_max_diff;
+    int rank, size;
+    int local_ny, start_y, end_y;
+    double start_time, end_time;
+    const double threshold = ACTIVITY_FRACTION * TOLERANCE;
+
+    // Initialize MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Start timing
+    start_time = MPI_Wtime();
+
+    // Divide the domain among processes (column-wise decomposition)
+    local_ny = (NY - 2) / size;
+    start_y = rank * local_ny + 1;
+    end_y = (rank == size - 1) ? (NY - 1) : (start_y + local_ny);
+
+    // Allocate local arrays with ghost columns
+    int actual_ny = end_y - start_y + 2;
+    u = (double **)malloc(NX * sizeof(double *));
+    u_new = (double **)malloc(NX * sizeof(double *));
+    for (i = 0; i < NX; i++) {
+        u[i] = (double *)malloc(actual_ny * sizeof(double));
+        u_new[i] = (double *)malloc(actual_ny * sizeof(double));
+    }
+    last_left = (double *)malloc(NX * sizeof(double));
+    last_right = (double *)malloc(NX * sizeof(double));
+    recv_left = (double *)malloc(NX * sizeof(double));
+    recv_right = (double *)malloc(NX * sizeof(double));
+    int left = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
+    int right = (rank < size - 1) ? rank + 1 : MPI_PROC_NULL;
+
+    // Activity map over the interior rows 1..NX-2 and columns 1..actual_ny-2
+    int tiles_x = (NX - 2 + TILE_X - 1) / TILE_X;
+    int tiles_y = (actual_ny - 2 + TILE_Y - 1) / TILE_Y;
+    int ntiles = tiles_x * tiles_y;
+    double *change = (double *)malloc(ntiles * sizeof(double));
+    double *ghost_change_left = (double *)calloc(tiles_x, sizeof(double));
+    double *ghost_change_right = (double *)calloc(tiles_x, sizeof(double));
+    int *active = (int *)malloc(ntiles * sizeof(int));
+    for (int t = 0; t < ntiles; t++) change[t] = HUGE_VAL;
+
+    // Initialize local grid; ghost columns start consistent with the neighbours
+    #pragma omp parallel for private(i, j) collapse(2)
+    for (i = 0; i < NX; i++) {
+        for (j = 0; j < actual_ny; j++) {
+            int global_j = start_y + j - 1;
+            u[i][j] = 0.0;
+            if (i == 0 || i == NX - 1 || global_j == 0 || global_j == NY - 1) {
+                u[i][j] = 100.0;
+            }
+            u_new[i][j] = u[i][j];
+        }
+    }
+    for (i = 0; i < NX; i++) {
+        last_left[i] = u[i][1];
+        last_right[i] = u[i][actual_ny - 2];
+    }
+
+    int send_left = 0, send_right = 0, got_left, got_right;
+    long tile_updates = 0, messages_sent = 0;
+
+    // Iterative solver
+    for (iter = 0; iter < MAX_ITER; iter++) {
+        // Exchange the halos whose edge column moved; the others send nothing
+        MPI_Request req[4];
+        MPI_Status status[4];
+        MPI_Irecv(recv_left, NX, MPI_DOUBLE, left, 1, MPI_COMM_WORLD, &req[0]);
+        MPI_Irecv(recv_right, NX, MPI_DOUBLE, right, 0, MPI_COMM_WORLD, &req[1]);
+        if (send_left) {
+            for (i = 0; i < NX; i++) last_left[i] = u[i][1];
+        }
+        if (send_right) {
+            for (i = 0; i < NX; i++) last_right[i] = u[i][actual_ny - 2];
+        }
+        MPI_Isend(last_left, send_left ? NX : 0, MPI_DOUBLE, left, 0, MPI_COMM_WORLD, &req[2]);
+        MPI_Isend(last_right, send_right ? NX : 0, MPI_DOUBLE, right, 1, MPI_COMM_WORLD, &req[3]);
+        messages_sent += send_left + send_right;
+        MPI_Waitall(4, req, status);
+
+        // Receives from MPI_PROC_NULL complete empty as well
+        MPI_Get_count(&status[0], MPI_DOUBLE, &got_left);
+        MPI_Get_count(&status[1], MPI_DOUBLE, &got_right);
+
+        // Unpack received ghosts and record how much each tile row's ghost moved
+        for (int ti = 0; ti < tiles_x; ti++) {
+            ghost_change_left[ti] = 0.0;
+            ghost_change_right[ti] = 0.0;
+        }
+        for (i = 1; i < NX - 1; i++) {
+            int ti = (i - 1) / TILE_X;
+            if (got_left) {
+                double d = fabs(recv_left[i] - u[i][0]);
+                if (d > ghost_change_left[ti]) ghost_change_left[ti] = d;
+                u[i][0] = recv_left[i];
+            }
+            if (got_right) {
+                double d = fabs(recv_right[i] - u[i][actual_ny - 1]);
+                if (d > ghost_change_right[ti]) ghost_change_right[ti] = d;
+                u[i][actual_ny - 1] = recv_right[i];
+            }
+        }
+
+        // Mark tiles that moved, or whose neighbours moved, last iteration
+        int nactive = 0;
+        for (int ti = 0; ti < tiles_x; ti++) {
+            for (int tj = 0; tj < tiles_y; tj++) {
+                int t = ti * tiles_y + tj;
+                int wake = change[t] > threshold;
+                if (ti > 0 && change[t - tiles_y] > threshold) wake = 1;
+                if (ti < tiles_x - 1 && change[t + tiles_y] > threshold) wake = 1;
+                if (tj > 0 ? change[t - 1] > threshold : ghost_change_left[ti] > threshold) wake = 1;
+                if (tj < tiles_y - 1 ? change[t + 1] > threshold : ghost_change_right[ti] > threshold) wake = 1;
+                if (wake) {
+                    active[nactive++] = t;
+                } else {
+                    change[t] = 0.0;
+                }
+            }
+        }
+        tile_updates += nactive;
+
+        // Sweep the active tiles into u_new
+        max_diff = 0.0;
+        int k;
+        #pragma omp parallel for private(i) reduction(max:max_diff) schedule(dynamic)
+        for (k = 0; k < nactive; k++) {
+            int t = active[k];
+            int i0 = 1 + (t / tiles_y) * TILE_X, j0 = 1 + (t % tiles_y) * TILE_Y;
+            int i1 = (i0 + TILE_X < NX - 1) ? i0 + TILE_X : NX - 1;
+            int j1 = (j0 + TILE_Y < actual_ny - 1) ? j0 + TILE_Y : actual_ny - 1;
+            double tile_diff = 0.0;
+            for (i = i0; i < i1; i++) {
+                double diff = stencil_5pt_row(u, u_new, NULL, 0, i, j0, j1, 0);
+                if (diff > tile_diff) {
+                    tile_diff = diff;
+                }
+            }
+            change[t] = tile_diff;
+            if (tile_diff > max_diff) {
+                max_diff = tile_diff;
+            }
+        }
+
+        // Copy the active tiles back into u
+        #pragma omp parallel for private(i, j) schedule(dynamic)
+        for (k = 0; k < nactive; k++) {
+            int t = active[k];
+            int i0 = 1 + (t / tiles_y) * TILE_X, j0 = 1 + (t % tiles_y) * TILE_Y;
+            int i1 = (i0 + TILE_X < NX - 1) ? i0 + TILE_X : NX - 1;
+            int j1 = (j0 + TILE_Y < actual_ny - 1) ? j0 + TILE_Y : actual_ny - 1;
+            for (i = i0; i < i1; i++) {
+                for (j = j0; j < j1; j++) {
+                    u[i][j] = u_new[i][j];
+                }
+            }
+        }
+
+        // Decide which edge columns need to be sent next iteration
+        double edge_left = 0.0, edge_right = 0.0;
+        for (i = 1; i < NX - 1; i++) {
+            edge_left = fmax(edge_left, fabs(u[i][1] - last_left[i]));
+            edge_right = fmax(edge_right, fabs(u[i][actual_ny - 2] - last_right[i]));
+        }
+        send_left = (left != MPI_PROC_NULL && edge_left > threshold);
+        send_right = (right != MPI_PROC_NULL && edge_right > threshold);
+
+        // Global reduction to find maximum difference
+        MPI_Allreduce(&max_diff, &global_max_diff, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+        // Check for convergence
+        if (global_max_diff < TOLERANCE) {
+            if (rank == 0) {
+                printf("Converged after %d iterations.\n", iter);
+            }
+            break;
+        }
+    }
+
+    // End timing
+    end_time = MPI_Wtime();
+
+    // Work and traffic actually done versus a full sweep every iteration
+    int iterations = (iter < MAX_ITER) ? iter + 1 : MAX_ITER;
+    long counts[4], totals[4];
+    double local_sum = 0.0, sum;
+    counts[0] = tile_updates;
+    counts[1] = (long)ntiles * iterations;
+    counts[2] = messages_sent;
+    counts[3] = (long)((left != MPI_PROC_NULL) + (right != MPI_PROC_NULL)) * iterations;
+    for (i = 1; i < NX - 1; i++) {
+        for (j = 1; j < actual_ny - 1; j++) {
+            local_sum += u[i][j];
+        }
+    }
+    MPI_Reduce(counts, totals, 4, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&local_sum, &sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        printf("Tiles updated: %ld of %ld (%.1f%%)\n", totals[0], totals[1],
+               100.0 * totals[0] / totals[1]);
+        if (totals[3] > 0) {
+            printf("Halo messages sent: %ld of %ld (%.1f%%)\n", totals[2], totals[3],
+                   100.0 * totals[2] / totals[3]);
+        }
+        printf("Average interior temperature: %.6f\n", sum / ((double)(NX - 2) * (NY - 2)));
+        printf("Lazy execution time: %f seconds\n", end_time - start_time);
+    }
+
+    // Free memory
+    for (i = 0; i < NX; i++) {
+        free(u[i]);
+        free(u_new[i]);
+    }
+    free(u);
+    free(u_new);
+    free(last_left);
+    free(last_right);
+    free(recv_left);
+    free(recv_right);
+    free(change);
+    free(ghost_change_left);
+    free(ghost_change_right);
+    free(active);
+
+    MPI_Finalize();
+    return 0;
+}
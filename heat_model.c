@@ -0,0 +1,575 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <mpi.h>
+#include <omp.h>
+#include "libheat.h"
+#include "heat_stencil.h"
+
+#define NX 500
+#define NY 500
+
+#define MODEL_ITERS 200         // Timed iterations per measured run
+#define MODEL_WARMUP 5
+#define MAX_PROJECTED 64        // Rank counts are projected up to this many
+#define STREAM_N (1 << 23)      // Triad elements per node, split over its ranks
+#define CACHE_MIN (16 << 10)    // Working-set sweep of the bandwidth curve, bytes
+#define CACHE_MAX (128 << 20)
+#define CACHE_BYTES 2e8         // Traffic per point of the curve
+#define FLOP_LANES 32           // Independent multiply-add chains per thread
+#define FLOP_ITERS 2000000
+#define PING_MAX (4 << 20)
+#define BELOW_BOUND 0.5         // Flag runs slower than half their predicted time
+#define MAX_HALO 32             // Widest deep halo tried, as in heat_deep_halo
+
+// Measured roofline and latency-bandwidth model of the Jacobi solvers.
+//
+//   mpirun -np P ./heat_model [nx ny [iters [max_ranks]]]
+//
+// Measures this machine instead of assuming speedups: STREAM triad bandwidth
+// of the node, the bandwidth of one rank against its working-set size (the
+// cache levels show up as plateaus), the multiply-add rate of one rank, and
+// MPI ping-pong latency and bandwidth between the first and last rank.
+//
+// Each solver variant is described by its traffic and arithmetic per grid
+// point and its halo width. For a decomposition over P ranks (columns, as in
+// the solvers) the predicted time of one iteration is
+//
+//     max(bytes / bandwidth(working set), flops / peak)         roofline
+//   + 2 (alpha + halo bytes / beta) + ceil(log2 P) (alpha + 8 / beta)
+//
+// where the bandwidth is the cache-curve value for the rank's working set,
+// capped at the node's STREAM share when the working sets of the ranks on a
+// node no longer fit in the last-level cache. Ranks and threads beyond the
+// node's cores share them, so bandwidth and peak shrink in proportion.
+//
+// The deep-halo, shared-memory and in-place solvers change the terms: deep
+// halos exchange k columns once every k iterations and redo (k - 1) columns of
+// work per step; heat_shm reads same-node ghosts from its neighbours' buffers
+// without messages or packing; heat_inplace and the other two swap or share
+// buffers, so they have no copy-back, and heat_inplace stores one grid.
+//
+// Every rank count up to the launched one is also run (libheat, and the
+// heat_stencil.h kernels with the heat_stencil exchange) on a sub-communicator
+// and the measured time printed beside the prediction; larger counts are
+// projected for nodes like this one. The other solvers are separate programs
+// and are only predicted; persistent, tasks, lazy and ooc are not modelled.
+
+typedef struct {
+    int node_size, threads;
+    int cores;                  // Online processors of the node
+    double stream;              // Node STREAM triad, bytes/s
+    int nsizes;
+    double ws[32], bw[32];      // One rank's triad bandwidth by working set
+    double llc;                 // Largest working set above the memory plateau
+    double flops;               // One rank, flop/s
+    double alpha, beta;         // Ping-pong latency (s) and bandwidth (bytes/s)
+    double allreduce;           // Measured 8-byte MPI_Allreduce over all ranks
+} machine_t;
+
+typedef struct {
+    const char *name;
+    const stencil_t *st;        // NULL: libheat, as run by heat_serial/heat_parallel
+    int radius;
+    double flops;               // Per grid point and iteration
+    double bytes;               // Memory traffic per grid point and iteration
+    int grids;                  // Grid copies in the working set
+    int steps;                  // Iterations per halo exchange (deep halo: k)
+    int shared;                 // Same-node neighbours read ghosts in place
+    int measured;               // Timed here; the others are separate programs
+} variant_t;
+
+// Sweep reads u and writes u_new, the copy-back reads u_new and writes u;
+// the neighbour rows come from cache
+#define BYTES_PER_POINT (4.0 * sizeof(double))
+
+// Without a copy-back only the sweep's read and write remain
+#define SWAP_BYTES_PER_POINT (2.0 * sizeof(double))
+
+// Packing a ghost column touches one cache line per grid row
+#define LINE_BYTES 64.0
+
+static int rank, size;
+
+// STREAM triad a = b + s * c on all ranks of the node at once; returns the
+// node bandwidth in bytes/s (best of several repetitions)
+static double stream_triad(MPI_Comm node_comm) {
+    int node_size, rep;
+    MPI_Comm_size(node_comm, &node_size);
+    long n = STREAM_N / node_size, i;
+    double *a = (double *)malloc(n * sizeof(double));
+    double *b = (double *)malloc(n * sizeof(double));
+    double *c = (double *)malloc(n * sizeof(double));
+    double best = 1e30;
+
+    #pragma omp parallel for
+    for (i = 0; i < n; i++) {
+        a[i] = 0.0;
+        b[i] = 1.0;
+        c[i] = 2.0;
+    }
+    for (rep = 0; rep < 5; rep++) {
+        MPI_Barrier(node_comm);
+        double t0 = MPI_Wtime();
+        #pragma omp parallel for
+        for (i = 0; i < n; i++) {
+            a[i] = b[i] + 3.0 * c[i];
+        }
+        double t = MPI_Wtime() - t0;
+        MPI_Allreduce(MPI_IN_PLACE, &t, 1, MPI_DOUBLE, MPI_MAX, node_comm);
+        if (t < best) best = t;
+    }
+    // Keep the stores observable
+    if (a[n / 2] != 7.0) fprintf(stderr, "stream_triad: unexpected result\n");
+    free(a);
+    free(b);
+    free(c);
+    return 3.0 * sizeof(double) * n * node_size / best;
+}
+
+// Triad bandwidth of this rank's threads on a working set of ws bytes. Each
+// thread keeps its own slice, so the slices stay in that core's caches.
+static double triad_bandwidth(double *buf, double ws) {
+    const long n = (long)(ws / (3 * sizeof(double)));
+    const int reps = (int)fmax(2.0, CACHE_BYTES / ws);
+    double *a = buf, *b = buf + n, *c = buf + 2 * n;
+    double best = 1e30;
+
+    for (int trial = 0; trial < 3; trial++) {
+        double t0 = 0.0;
+        #pragma omp parallel
+        {
+            // First pass warms the caches, the rest are timed
+            for (int r = 0; r <= reps; r++) {
+                if (r == 1) {
+                    #pragma omp barrier
+                    #pragma omp master
+                    t0 = omp_get_wtime();
+                }
+                #pragma omp for schedule(static) nowait
+                for (long i = 0; i < n; i++) {
+                    a[i] = b[i] + 3.0 * c[i];
+                }
+            }
+        }
+        double t = omp_get_wtime() - t0;
+        if (t < best) best = t;
+    }
+    return 3.0 * sizeof(double) * n * reps / best;
+}
+
+// Bandwidth curve of one rank (the others idle) from CACHE_MIN to CACHE_MAX
+static void cache_curve(machine_t *m) {
+    double *buf = (double *)malloc(CACHE_MAX);
+    long i;
+
+    #pragma omp parallel for schedule(static)
+    for (i = 0; i < CACHE_MAX / (long)sizeof(double); i++) buf[i] = 1.0;
+    m->nsizes = 0;
+    for (double ws = CACHE_MIN; ws <= CACHE_MAX; ws *= 2) {
+        m->ws[m->nsizes] = ws;
+        m->bw[m->nsizes] = triad_bandwidth(buf, ws);
+        m->nsizes++;
+    }
+    free(buf);
+
+    // Memory plateau: the largest sizes; the LLC ends where the curve drops to it
+    double plateau = m->bw[m->nsizes - 1];
+    m->llc = m->ws[0];
+    for (int k = 0; k < m->nsizes; k++) {
+        if (m->bw[k] > 1.25 * plateau) m->llc = m->ws[k];
+    }
+}
+
+// Multiply-add rate of this rank's threads on register-resident data
+static double peak_flops(void) {
+    double best = 1e30, sink = 0.0;
+
+    for (int trial = 0; trial < 3; trial++) {
+        double t0 = omp_get_wtime();
+        #pragma omp parallel reduction(+:sink)
+        {
+            double x[FLOP_LANES];
+            for (int k = 0; k < FLOP_LANES; k++) x[k] = 1.0 + k * 1e-3;
+            for (long n = 0; n < FLOP_ITERS; n++) {
+                #pragma omp simd
+                for (int k = 0; k < FLOP_LANES; k++) {
+                    x[k] = x[k] * 0.999999 + 1e-7;
+                }
+            }
+            for (int k = 0; k < FLOP_LANES; k++) sink += x[k];
+        }
+        double t = omp_get_wtime() - t0;
+        if (t < best) best = t;
+    }
+    if (sink == 0.0) fprintf(stderr, "peak_flops: unexpected result\n");
+    return 2.0 * FLOP_LANES * (double)FLOP_ITERS * omp_get_max_threads() / best;
+}
+
+// Half round trip between ranks a and b for an n-byte message, best of reps
+static double ping_pong(char *buf, int n, int a, int b, int reps) {
+    double best = 1e30;
+
+    for (int r = 0; r < reps; r++) {
+        double t0 = MPI_Wtime();
+        if (rank == a) {
+            MPI_Send(buf, n, MPI_CHAR, b, 0, MPI_COMM_WORLD);
+            MPI_Recv(buf, n, MPI_CHAR, b, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        } else if (rank == b) {
+            MPI_Recv(buf, n, MPI_CHAR, a, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(buf, n, MPI_CHAR, a, 0, MPI_COMM_WORLD);
+        }
+        double t = (MPI_Wtime() - t0) / 2.0;
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+// Latency from the smallest message, bandwidth from the slope to the largest
+static void mpi_model(machine_t *m) {
+    char *buf = (char *)calloc(PING_MAX, 1);
+    double x = 1.0;
+
+    m->alpha = 0.0;
+    m->beta = 1e30;
+    if (size > 1) {
+        double t_small = ping_pong(buf, 8, 0, size - 1, 1000);
+        double t_large = ping_pong(buf, PING_MAX, 0, size - 1, 20);
+        m->alpha = t_small;
+        m->beta = (PING_MAX - 8) / fmax(t_large - t_small, 1e-9);
+    }
+    MPI_Bcast(&m->alpha, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&m->beta, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    m->allreduce = 1e30;
+    for (int r = 0; r < 200; r++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        double t0 = MPI_Wtime();
+        MPI_Allreduce(MPI_IN_PLACE, &x, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        double t = MPI_Wtime() - t0;
+        if (t < m->allreduce) m->allreduce = t;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &m->allreduce, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    free(buf);
+}
+
+// Cache-curve bandwidth at working set ws, log-linear between measured sizes
+static double curve_bandwidth(const machine_t *m, double ws) {
+    if (ws <= m->ws[0]) return m->bw[0];
+    for (int k = 1; k < m->nsizes; k++) {
+        if (ws <= m->ws[k]) {
+            double f = log(ws / m->ws[k - 1]) / log(m->ws[k] / m->ws[k - 1]);
+            return m->bw[k - 1] + f * (m->bw[k] - m->bw[k - 1]);
+        }
+    }
+    return m->bw[m->nsizes - 1];
+}
+
+// Predicted seconds per iteration of variant v on nranks ranks; *bound names
+// the limiting resource
+static double predict(const machine_t *m, const variant_t *v, int nx, int ny, int nranks,
+                      double *t_comm, const char **bound) {
+    const int R = v->radius, k = v->steps;
+    const int cols = (ny - 2 * R + nranks - 1) / nranks;       // Widest rank
+    // A deep halo shrinks by R columns per side and step: R (k - 1) extra on average
+    const double points = (double)(nx - 2 * R) * (cols + (nranks > 1 ? R * (k - 1) : 0));
+    const double ws = (double)v->grids * sizeof(double) * nx * (cols + 2 * R * k);
+    const int on_node = (nranks < m->node_size) ? nranks : m->node_size;
+    const double busy = (double)on_node * m->threads;
+    const double share = (busy > m->cores ? m->cores / busy : 1.0) /
+                         (m->threads > m->cores ? (double)m->cores / m->threads : 1.0);
+    double bw = curve_bandwidth(m, ws) * share;
+
+    *bound = "cache";
+    if (ws * on_node > m->llc) {
+        *bound = "memory";
+        if (bw > m->stream / on_node) bw = m->stream / on_node;
+    }
+    // Faces that exchange messages; with shared memory only those to other nodes
+    int faces = (nranks > 1) ? 2 : 0;
+    if (v->shared && faces > 0) faces = (nranks > m->node_size) ? 1 : 0;
+    double bytes = v->bytes * points;
+    if (faces > 0) {
+        // Pack and unpack; k ghost columns per row share the cache lines
+        bytes += 2.0 * faces * fmax(LINE_BYTES, sizeof(double) * R * k) * nx / k;
+    }
+    if (v->shared && nranks > 1) {
+        bytes += (2 - faces) * LINE_BYTES * nx;                 // Ghosts read in place
+    }
+    double t_mem = bytes / bw;
+    double t_flop = v->flops * points / (m->flops * share);
+    if (t_flop > t_mem) *bound = "compute";
+
+    *t_comm = 0.0;
+    if (nranks > 1) {
+        double halo = sizeof(double) * (double)nx * R * k;
+        *t_comm = (faces * (m->alpha + halo / m->beta) +
+                   ceil(log2(nranks)) * (m->alpha + sizeof(double) * k / m->beta)) / k;
+    }
+    return fmax(t_mem, t_flop) + *t_comm;
+}
+
+// Seconds per iteration of libheat on comm
+static double time_libheat(MPI_Comm comm, int nx, int ny, int iters) {
+    heat_options_t opts;
+    heat_options_default(&opts, nx, ny);
+    heat_solver_t *s = heat_create_mpi(&opts, comm);
+    if (s == NULL) return -1.0;
+
+    heat_step(s, MODEL_WARMUP);
+    MPI_Barrier(comm);
+    double t0 = MPI_Wtime();
+    heat_step(s, iters);
+    double t = (MPI_Wtime() - t0) / iters;
+    MPI_Allreduce(MPI_IN_PLACE, &t, 1, MPI_DOUBLE, MPI_MAX, comm);
+    heat_destroy(s);
+    return t;
+}
+
+// Seconds per iteration of a heat_stencil.h kernel on comm, with the ghost
+// exchange, copy-back and reduction of heat_stencil
+static double time_stencil(MPI_Comm comm, const stencil_t *st, int nx, int ny, int iters) {
+    const int R = stencil_radius(st);
+    int crank, csize, i, j, r, iter;
+    MPI_Comm_rank(comm, &crank);
+    MPI_Comm_size(comm, &csize);
+
+    int local_ny = (ny - 2 * R) / csize;
+    int start_y = crank * local_ny + R;
+    int end_y = (crank == csize - 1) ? (ny - R) : (start_y + local_ny);
+    int actual_ny = end_y - start_y + 2 * R;
+    double **u = (double **)malloc(nx * sizeof(double *));
+    double **u_new = (double **)malloc(nx * sizeof(double *));
+    for (i = 0; i < nx; i++) {
+        u[i] = (double *)malloc(actual_ny * sizeof(double));
+        u_new[i] = (double *)malloc(actual_ny * sizeof(double));
+        for (j = 0; j < actual_ny; j++) {
+            int global_j = start_y + j - R;
+            u[i][j] = (i < R || i >= nx - R || global_j < R || global_j >= ny - R) ? 100.0 : 0.0;
+            u_new[i][j] = u[i][j];
+        }
+    }
+    double *send_buf = (double *)malloc((size_t)nx * R * sizeof(double));
+    double *recv_buf = (double *)malloc((size_t)nx * R * sizeof(double));
+    int left = (crank > 0) ? crank - 1 : MPI_PROC_NULL;
+    int right = (crank < csize - 1) ? crank + 1 : MPI_PROC_NULL;
+    double t0 = 0.0;
+
+    for (iter = 0; iter < MODEL_WARMUP + iters; iter++) {
+        if (iter == MODEL_WARMUP) {
+            MPI_Barrier(comm);
+            t0 = MPI_Wtime();
+        }
+        for (i = 0; i < nx; i++)
+            for (r = 0; r < R; r++) send_buf[i * R + r] = u[i][R + r];
+        MPI_Sendrecv(send_buf, nx * R, MPI_DOUBLE, left, 0,
+                     recv_buf, nx * R, MPI_DOUBLE, right, 0, comm, MPI_STATUS_IGNORE);
+        if (right != MPI_PROC_NULL) {
+            for (i = 0; i < nx; i++)
+                for (r = 0; r < R; r++) u[i][actual_ny - R + r] = recv_buf[i * R + r];
+        }
+        for (i = 0; i < nx; i++)
+            for (r = 0; r < R; r++) send_buf[i * R + r] = u[i][actual_ny - 2 * R + r];
+        MPI_Sendrecv(send_buf, nx * R, MPI_DOUBLE, right, 1,
+                     recv_buf, nx * R, MPI_DOUBLE, left, 1, comm, MPI_STATUS_IGNORE);
+        if (left != MPI_PROC_NULL) {
+            for (i = 0; i < nx; i++)
+                for (r = 0; r < R; r++) u[i][r] = recv_buf[i * R + r];
+        }
+
+        double max_diff = st->sweep(u, u_new, R, nx - R, R, actual_ny - R);
+
+        #pragma omp parallel for private(i, j) collapse(2)
+        for (i = R; i < nx - R; i++) {
+            for (j = R; j < actual_ny - R; j++) {
+                u[i][j] = u_new[i][j];
+            }
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &max_diff, 1, MPI_DOUBLE, MPI_MAX, comm);
+    }
+    double t = (MPI_Wtime() - t0) / iters;
+    MPI_Allreduce(MPI_IN_PLACE, &t, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+    for (i = 0; i < nx; i++) {
+        free(u[i]);
+        free(u_new[i]);
+    }
+    free(u);
+    free(u_new);
+    free(send_buf);
+    free(recv_buf);
+    return t;
+}
+
+// Arithmetic of a stencil row update: one multiply per non-unit coefficient,
+// the additions, the centre scaling, the change, and the damping if any
+static double stencil_flops(const stencil_point_t *pts, int npts, double omega) {
+    double f = npts - 1 + 2.0;
+    for (int p = 0; p < npts; p++) {
+        if (fabs(pts[p].c) != 1.0) f += 1.0;
+    }
+    return (omega != 1.0) ? f + 3.0 : f;
+}
+
+#define NPTS(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static void print_bandwidth(const char *label, double bytes_per_s) {
+    printf("%s%.1f MB/s\n", label, bytes_per_s / 1e6);
+}
+
+static void print_row(const char *name, int nranks, const char *bound, double pred,
+                      double comm, double meas) {
+    printf("%-8s %6d  %-8s %12.3f %10.3f", name, nranks, bound, pred * 1e3, comm * 1e3);
+    if (meas > 0.0) {
+        double eff = pred / meas;
+        printf(" %12.3f %7.0f%%%s\n", meas * 1e3, 100.0 * eff,
+               (eff < BELOW_BOUND) ? "  <- below bound" : "");
+    } else {
+        printf(" %12s %8s\n", "-", "-");
+    }
+}
+
+int main(int argc, char **argv) {
+    int nx = NX, ny = NY, iters = MODEL_ITERS, max_ranks = MAX_PROJECTED;
+    machine_t m;
+    MPI_Comm node_comm;
+
+    // Initialize MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc > 2) {
+        nx = atoi(argv[1]);
+        ny = atoi(argv[2]);
+    }
+    if (argc > 3) iters = atoi(argv[3]);
+    if (argc > 4) max_ranks = atoi(argv[4]);
+    if (nx < 8 || ny < 8 || iters < 1) {
+        if (rank == 0) fprintf(stderr, "Usage: %s [nx ny [iters [max_ranks]]]\n", argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    const variant_t variants[] = {
+        { "libheat", NULL, 1, 6.0, BYTES_PER_POINT, 2, 1, 0, 1 },
+        { "5pt", &stencil_5pt, stencil_radius(&stencil_5pt),
+          stencil_flops(stencil_5pt_points, NPTS(stencil_5pt_points), 1.0),
+          BYTES_PER_POINT, 2, 1, 0, 1 },
+        { "9pt", &stencil_9pt, stencil_radius(&stencil_9pt),
+          stencil_flops(stencil_9pt_points, NPTS(stencil_9pt_points), 1.0),
+          BYTES_PER_POINT, 2, 1, 0, 1 },
+        { "wide4", &stencil_wide4, stencil_radius(&stencil_wide4),
+          stencil_flops(stencil_wide4_points, NPTS(stencil_wide4_points), 0.8),
+          BYTES_PER_POINT, 2, 1, 0, 1 },
+        { "deep", NULL, 1, 6.0, SWAP_BYTES_PER_POINT, 2, 0, 0, 0 },     // steps: best k
+        { "shm", NULL, 1, 6.0, SWAP_BYTES_PER_POINT, 2, 1, 1, 0 },
+        { "inplace", NULL, 1, 6.0, SWAP_BYTES_PER_POINT, 1, 1, 0, 0 },
+    };
+    const int num_variants = NPTS(variants);
+
+    // Machine: node bandwidth with every rank busy, the rest on rank 0 alone
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_size(node_comm, &m.node_size);
+    m.threads = omp_get_max_threads();
+    m.cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (m.cores < 1) m.cores = 1;
+    m.stream = stream_triad(node_comm);
+    MPI_Allreduce(MPI_IN_PLACE, &m.stream, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+    if (rank == 0) {
+        cache_curve(&m);
+        m.flops = peak_flops();
+    }
+    MPI_Bcast(&m.nsizes, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(m.ws, m.nsizes, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(m.bw, m.nsizes, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&m.llc, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&m.flops, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    mpi_model(&m);
+
+    if (rank == 0) {
+        printf("Machine: %d ranks (%d per node) x %d threads, %d cores per node\n",
+               size, m.node_size, m.threads, m.cores);
+        if (m.node_size * m.threads > m.cores) {
+            printf("  Oversubscribed: ranks and threads share cores\n");
+        }
+        print_bandwidth("  STREAM triad (node):      ", m.stream);
+        printf("  Rank bandwidth by working set:\n");
+        for (int k = 0; k < m.nsizes; k++) {
+            printf("    %8.0f KB %12.1f MB/s\n", m.ws[k] / 1024.0, m.bw[k] / 1e6);
+        }
+        printf("  Last-level cache (est.):   %.0f KB\n", m.llc / 1024.0);
+        printf("  Peak multiply-add (rank):  %.2f GFLOP/s\n", m.flops / 1e9);
+        if (size > 1) {
+            printf("  MPI ping-pong 0<->%d:       latency %.2f us, bandwidth %.1f MB/s%s\n",
+                   size - 1, m.alpha * 1e6, m.beta / 1e6,
+                   (m.node_size == size) ? " (same node)" : "");
+        } else {
+            printf("  MPI ping-pong:             needs 2 or more ranks, communication not modelled\n");
+        }
+        printf("  MPI_Allreduce (%d ranks):   %.2f us\n", size, m.allreduce * 1e6);
+        printf("\nGrid %dx%d, %d iterations per measurement, times per iteration\n", nx, ny, iters);
+        printf("%-8s %6s  %-8s %12s %10s %12s %8s\n",
+               "Variant", "Ranks", "Bound", "Predicted ms", "Comm ms", "Measured ms", "Bound%");
+    }
+
+    // Measured runs on the first P ranks for P = 1, 2, 4, ..., size; then
+    // projections for larger power-of-two counts
+    int below = 0;
+    for (int v = 0; v < num_variants; v++) {
+        for (int p = 1; p <= size || p <= max_ranks; p = (p < size && 2 * p > size) ? size : 2 * p) {
+            variant_t var_k = variants[v];
+            const variant_t *var = &var_k;
+            const char *bound;
+            char name[16];
+            double comm, meas = -1.0, pred;
+            if ((ny - 2 * var->radius) / p < 2 * var->radius) break;
+            if (var->steps == 0) {
+                // Deep halo: the width heat_deep_halo would aim for, i.e. the
+                // fastest predicted one that fits in the narrowest rank
+                int best = 1;
+                double best_t = 1e30, c;
+                const char *b;
+                for (int k = 1; k <= MAX_HALO && k <= (ny - 2) / p; k++) {
+                    var_k.steps = k;
+                    double t = predict(&m, var, nx, ny, p, &c, &b);
+                    if (t < best_t) {
+                        best_t = t;
+                        best = k;
+                    }
+                }
+                var_k.steps = best;
+                snprintf(name, sizeof(name), "%s k=%d", var->name, best);
+                var_k.name = name;
+            }
+            pred = predict(&m, var, nx, ny, p, &comm, &bound);
+
+            if (p <= size && var->measured) {
+                MPI_Comm sub;
+                MPI_Comm_split(MPI_COMM_WORLD, (rank < p) ? 0 : MPI_UNDEFINED, rank, &sub);
+                if (sub != MPI_COMM_NULL) {
+                    meas = (var->st == NULL) ? time_libheat(sub, nx, ny, iters)
+                                             : time_stencil(sub, var->st, nx, ny, iters);
+                    MPI_Comm_free(&sub);
+                }
+                MPI_Barrier(MPI_COMM_WORLD);
+            }
+            if (rank == 0) {
+                print_row(var->name, p, bound, pred, comm, meas);
+                if (meas > 0.0 && pred / meas < BELOW_BOUND) below++;
+            }
+        }
+    }
+    if (rank == 0) {
+        printf("\nRanks above %d are projected for nodes like this one, %d per node.\n",
+               size, m.node_size);
+        printf("%d measured run(s) below %.0f%% of the predicted bound\n", below, 100.0 * BELOW_BOUND);
+    }
+
+    MPI_Comm_free(&node_comm);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,212 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <omp.h>
+#include "heat_config.h"
+
+#define NX 500
+#define NY 500
+#define MAX_ITER 1000
+#define TOLERANCE 1e-6
+
+// Out-of-core solver: the grid lives in two files, each holding N x N doubles
+// row-major, which alternate between input and output of a pass.
+//
+//   ./heat_ooc [n] [steps_per_pass] [band_rows] [dir]
+//
+// A pass streams the input file in bands of band_rows rows. Each band is read
+// with steps_per_pass extra rows on both sides, advanced steps_per_pass Jacobi
+// steps in memory with the shared kernel (the valid rows shrink by one per
+// step, as in the deep-halo solver), and its own rows are written to the output
+// file. Disk traffic is one read and one write of the grid per pass instead of
+// per iteration. The next band is prefetched with POSIX_FADV_WILLNEED while
+// the current one is computed, and consumed ranges are dropped from the page
+// cache so grids larger than RAM stream through.
+//
+// The reported I/O time is the time spent waiting on the disk: pread/pwrite
+// (a read of a prefetched band waits for the readahead here), the fadvise
+// calls and the fdatasync that forces each pass's output out of the page
+// cache. Without the sync, pwrite only copies into the cache.
+
+static int n = NX;              // Grid is n x n
+static double io_time = 0.0;     // All waits on the disk, sync included
+static double sync_time = 0.0;   // Part of io_time spent in fdatasync
+static double io_bytes = 0.0;
+
+static void rows_io(int fd, double *buf, long row0, long nrows, int write_op) {
+    char *p = (char *)buf;
+    size_t left = (size_t)nrows * n * sizeof(double);
+    off_t off = (off_t)row0 * n * sizeof(double);
+    double t0 = omp_get_wtime();
+
+    io_bytes += left;
+    while (left > 0) {
+        ssize_t done = write_op ? pwrite(fd, p, left, off) : pread(fd, p, left, off);
+        if (done <= 0) {
+            perror(write_op ? "pwrite" : "pread");
+            exit(1);
+        }
+        p += done;
+        off += done;
+        left -= done;
+    }
+    io_time += omp_get_wtime() - t0;
+}
+
+static void advise_rows(int fd, long row0, long nrows, int advice) {
+    if (nrows > 0) {
+        double t0 = omp_get_wtime();
+        posix_fadvise(fd, (off_t)row0 * n * sizeof(double), (off_t)nrows * n * sizeof(double), advice);
+        io_time += omp_get_wtime() - t0;
+    }
+}
+
+// Write back everything written to fd so far
+static void sync_file(int fd) {
+    double t0 = omp_get_wtime();
+    if (fdatasync(fd) != 0) {
+        perror("fdatasync");
+        exit(1);
+    }
+    double t = omp_get_wtime() - t0;
+    sync_time += t;
+    io_time += t;
+}
+
+int main(int argc, char **argv) {
+    int steps = 8, band = 64;
+    const char *dir = ".";
+    char path[2][4096];
+    int fd[2], src = 0;
+    int i, j, iter, s;
+    double start, end;
+
+    if (argc > 1) n = atoi(argv[1]);
+    if (argc > 2) steps = atoi(argv[2]);
+    if (argc > 3) band = atoi(argv[3]);
+    if (argc > 4) dir = argv[4];
+    if (n < 3 || steps < 1 || band < 1) {
+        fprintf(stderr, "Usage: %s [n] [steps_per_pass] [band_rows] [dir]\n", argv[0]);
+        return 1;
+    }
+    for (i = 0; i < 2; i++) {
+        snprintf(path[i], sizeof(path[i]), "%s/heat_ooc_%d.bin", dir, i);
+        fd[i] = open(path[i], O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd[i] < 0) {
+            perror(path[i]);
+            return 1;
+        }
+    }
+
+    // Band buffers: band rows plus steps halo rows per side, two time levels
+    int max_rows = band + 2 * steps;
+    if (max_rows > n) max_rows = n;
+    double **u = (double **)malloc(max_rows * sizeof(double *));
+    double **u_new = (double **)malloc(max_rows * sizeof(double *));
+    double *data = (double *)malloc(2 * (size_t)max_rows * n * sizeof(double));
+    double *step_diff = (double *)malloc(steps * sizeof(double));
+    double *row = (double *)malloc((size_t)n * sizeof(double));
+
+    // Start timing
+    start = omp_get_wtime();
+
+    // Initial grid: 100 on the boundary, 0 inside
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            row[j] = (i == 0 || i == n - 1 || j == 0 || j == n - 1) ? 100.0 : 0.0;
+        }
+        rows_io(fd[src], row, i, 1, 1);
+    }
+    sync_file(fd[src]);
+
+    // Each pass advances the whole grid by up to `steps` iterations
+    int converged = -1;
+    for (iter = 0; iter < MAX_ITER && converged < 0; iter += steps) {
+        int T = (iter + steps <= MAX_ITER) ? steps : MAX_ITER - iter;
+        int dst = 1 - src;
+        for (s = 0; s < T; s++) step_diff[s] = 0.0;
+
+        for (int b0 = 0; b0 < n; b0 += band) {
+            int b1 = (b0 + band < n) ? b0 + band : n;
+            int r0 = (b0 - T > 0) ? b0 - T : 0;
+            int r1 = (b1 + T < n) ? b1 + T : n;
+            int nrows = r1 - r0;
+
+            // Read this band with its halo rows; prefetch the next one
+            rows_io(fd[src], data, r0, nrows, 0);
+            advise_rows(fd[src], b1 + T, band, POSIX_FADV_WILLNEED);
+            memcpy(data + (size_t)nrows * n, data, (size_t)nrows * n * sizeof(double));
+            for (i = 0; i < nrows; i++) {
+                u[i] = data + (size_t)i * n;
+                u_new[i] = data + (size_t)(nrows + i) * n;
+            }
+
+            // T fused steps; the valid rows shrink by one per step except at
+            // the fixed top and bottom boundary rows
+            for (s = 0; s < T; s++) {
+                int lo = (r0 == 0) ? 1 : r0 + s + 1;
+                int hi = (r1 == n) ? n - 1 : r1 - s - 1;
+                if (lo < hi) {
+                    double d = heat_sweep_plain(u, u_new, NULL, 0, lo - r0, hi - r0, 1, n - 1);
+                    if (d > step_diff[s]) step_diff[s] = d;
+                }
+                double **tmp = u;
+                u = u_new;
+                u_new = tmp;
+            }
+
+            // Write the band's own rows and drop what this pass no longer needs
+            rows_io(fd[dst], u[b0 - r0], b0, b1 - b0, 1);
+            advise_rows(fd[src], 0, b1 - T, POSIX_FADV_DONTNEED);
+        }
+        sync_file(fd[dst]);
+        advise_rows(fd[dst], 0, n, POSIX_FADV_DONTNEED);
+        advise_rows(fd[src], 0, n, POSIX_FADV_DONTNEED);
+        src = dst;
+
+        // Check for convergence at each fused step
+        for (s = 0; s < T; s++) {
+            if (step_diff[s] < TOLERANCE) {
+                converged = iter + s;
+                break;
+            }
+        }
+    }
+    if (converged >= 0) {
+        printf("Converged after %d iterations.\n", converged);
+    }
+
+    // End timing
+    end = omp_get_wtime();
+    double solve_io_bytes = io_bytes, solve_io_time = io_time, solve_sync_time = sync_time;
+
+    double sum = 0.0;
+    for (i = 1; i < n - 1; i++) {
+        rows_io(fd[src], row, i, 1, 0);
+        for (j = 1; j < n - 1; j++) {
+            sum += row[j];
+        }
+    }
+    int passes = (iter + steps - 1) / steps;
+    printf("Grid %dx%d in %s: %d steps per pass, %d passes, bands of %d rows\n",
+           n, n, path[src], steps, passes, band);
+    printf("Average interior temperature: %.6f\n", sum / ((double)(n - 2) * (n - 2)));
+    printf("I/O: %.1f MB in %.3f seconds (%.1f MB/s), %.3f seconds of it in fdatasync\n",
+           solve_io_bytes / 1e6, solve_io_time,
+           solve_io_time > 0.0 ? solve_io_bytes / 1e6 / solve_io_time : 0.0, solve_sync_time);
+    printf("Out-of-core execution time: %f seconds\n", end - start);
+
+    // Free memory
+    free(u);
+    free(u_new);
+    free(data);
+    free(step_diff);
+    free(row);
+    close(fd[0]);
+    close(fd[1]);
+    return 0;
+}
@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "heat_stencil.h"
+
+#define NX 500
+#define NY 500
+#define MAX_ITER 1000
+#define TOLERANCE 1e-6
+
+// Spread per-thread counters over separate cache lines
+#define PAD 16
+#define SPIN_LIMIT 1024
+
+// Hybrid MPI+OpenMP solver with a single persistent parallel region.
+// Each thread owns a fixed strip of rows and only waits on the progress
+// counters of its two neighbouring strips. Thread 0 additionally performs
+// the (funneled) halo exchange and convergence reduction while the other
+// threads already compute the interior of the next iteration.
+
+static atomic_int progress[PAD * 256];   // iterations completed per thread
+static atomic_int halo_ready;            // iteration whose halo is in place
+static atomic_int stop_iter;             // converged iteration, or -1
+static double thread_diff[PAD * 256][2];  // local max diff, by parity
+
+// Spin until *flag >= value, yielding if the wait drags on
+static void wait_for(atomic_int *flag, int value) {
+    int spins = 0;
+    while (atomic_load_explicit(flag, memory_order_acquire) < value) {
+        if (++spins > SPIN_LIMIT) {
+            sched_yield();
+            spins = 0;
+        }
+    }
+}
+
+// Jacobi update of rows [i0, i1) and columns [j0, j1]. Each thread calls
+// this on its own strip, so it uses the row kernel, not the parallel sweep.
+static double update_block(double **u, double **u_new, int i0, int i1, int j0, int j1) {
+    double diff, max_diff = 0.0;
+
+    for (int i = i0; i < i1; i++) {
+        diff = stencil_5pt_row(u, u_new, NULL, 0, i, j0, j1 + 1, 0);
+        if (diff > max_diff) {
+            max_diff = diff;
+        }
+    }
+    return max_diff;
+}
+
+// Exchange ghost columns with neighbouring ranks (packed, one message each way)
+static void exchange_halo(double **u, int actual_ny, int rank, int size,
+                          double *send_buf, double *recv_buf) {
+    int i;
+    int up = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
+    int down = (rank < size - 1) ? rank + 1 : MPI_PROC_NULL;
+
+    for (i = 0; i < NX; i++) send_buf[i] = u[i][1];
+    MPI_Sendrecv(send_buf, NX, MPI_DOUBLE, up, 0,
+                 recv_buf, NX, MPI_DOUBLE, down, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    if (down != MPI_PROC_NULL) {
+        for (i = 0; i < NX; i++) u[i][actual_ny - 1] = recv_buf[i];
+    }
+
+    for (i = 0; i < NX; i++) send_buf[i] = u[i][actual_ny - 2];
+    MPI_Sendrecv(send_buf, NX, MPI_DOUBLE, down, 1,
+                 recv_buf, NX, MPI_DOUBLE, up, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    if (up != MPI_PROC_NULL) {
+        for (i = 0; i < NX; i++) u[i][0] = recv_buf[i];
+    }
+}
+
+int main(int argc, char **argv) {
+    double **buf[2];
+    double *send_buf, *recv_buf;
+    int i, j, provided;
+    int rank, size, nthreads;
+    int local_ny, start_y, end_y;
+    double start_time, end_time;
+
+    // Initialize MPI; only the master thread communicates
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (provided < MPI_THREAD_FUNNELED) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: MPI library does not support MPI_THREAD_FUNNELED\n");
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if (omp_get_max_threads() > 256) {
+        omp_set_num_threads(256);
+    }
+
+    // Start timing
+    start_time = MPI_Wtime();
+
+    // Divide the domain among processes (row-wise decomposition)
+    local_ny = (NY - 2) / size;  // Interior points only
+    start_y = rank * local_ny + 1;
+    end_y = (rank == size - 1) ? (NY - 1) : (start_y + local_ny);
+
+    // Allocate two local arrays with ghost rows; iterations alternate between them
+    int actual_ny = end_y - start_y + 2;  // +2 for ghost rows
+    for (int b = 0; b < 2; b++) {
+        buf[b] = (double **)malloc(NX * sizeof(double *));
+        for (i = 0; i < NX; i++) {
+            buf[b][i] = (double *)malloc(actual_ny * sizeof(double));
+        }
+    }
+    send_buf = (double *)malloc(NX * sizeof(double));
+    recv_buf = (double *)malloc(NX * sizeof(double));
+
+    // Initialize both buffers so boundary values survive the swaps
+    for (i = 0; i < NX; i++) {
+        for (j = 0; j < actual_ny; j++) {
+            int global_j = start_y + j - 1;
+            double value = 0.0;
+            if (i == 0 || i == NX - 1 || global_j == 0 || global_j == NY - 1) {
+                value = 100.0;
+            }
+            buf[0][i][j] = value;
+            buf[1][i][j] = value;
+        }
+    }
+
+    atomic_store(&halo_ready, -1);
+    atomic_store(&stop_iter, -1);
+    for (i = 0; i < PAD * 256; i += PAD) {
+        atomic_store(&progress[i], 0);
+    }
+
+    // Interior columns need no ghost data; edge columns wait for the halo
+    int inner_j0 = 2, inner_j1 = actual_ny - 3;
+    int edge_lo = 1, edge_hi = actual_ny - 2;
+
+    #pragma omp parallel private(i)
+    {
+        int t = omp_get_thread_num();
+        int nt = omp_get_num_threads();
+        int i0 = 1 + t * (NX - 2) / nt;
+        int i1 = 1 + (t + 1) * (NX - 2) / nt;
+        int k;
+
+        #pragma omp single
+        nthreads = nt;
+
+        for (k = 0; k < MAX_ITER; k++) {
+            double **u = buf[k % 2], **u_new = buf[(k + 1) % 2];
+            double max_diff = 0.0, d;
+
+            if (t == 0) {
+                // Whole local field of iteration k-1 must be complete
+                for (int s = 1; s < nt; s++) {
+                    wait_for(&progress[s * PAD], k);
+                }
+
+                if (k > 0) {
+                    double local_max = 0.0, global_max_diff;
+                    for (int s = 0; s < nt; s++) {
+                        if (thread_diff[s * PAD][(k - 1) % 2] > local_max) {
+                            local_max = thread_diff[s * PAD][(k - 1) % 2];
+                        }
+                    }
+                    MPI_Allreduce(&local_max, &global_max_diff, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+                    if (global_max_diff < TOLERANCE) {
+                        atomic_store_explicit(&stop_iter, k - 1, memory_order_relaxed);
+                    }
+                }
+
+                if (atomic_load_explicit(&stop_iter, memory_order_relaxed) < 0) {
+                    exchange_halo(u, actual_ny, rank, size, send_buf, recv_buf);
+                }
+                atomic_store_explicit(&halo_ready, k, memory_order_release);
+            } else {
+                // Neighbours must have finished iteration k-1 (read and write hazards)
+                wait_for(&progress[(t - 1) * PAD], k);
+                if (t + 1 < nt) {
+                    wait_for(&progress[(t + 1) * PAD], k);
+                }
+            }
+
+            // Interior columns can run ahead of the halo exchange
+            if (inner_j0 <= inner_j1) {
+                max_diff = update_block(u, u_new, i0, i1, inner_j0, inner_j1);
+            }
+
+            wait_for(&halo_ready, k);
+            if (atomic_load_explicit(&stop_iter, memory_order_relaxed) >= 0) {
+                break;
+            }
+
+            d = update_block(u, u_new, i0, i1, edge_lo, edge_lo);
+            if (d > max_diff) max_diff = d;
+            if (edge_hi != edge_lo) {
+                d = update_block(u, u_new, i0, i1, edge_hi, edge_hi);
+                if (d > max_diff) max_diff = d;
+            }
+
+            thread_diff[t * PAD][k % 2] = max_diff;
+            atomic_store_explicit(&progress[t * PAD], k + 1, memory_order_release);
+        }
+
+        // Decide the last iteration if the loop ran out without converging
+        if (t == 0 && k == MAX_ITER) {
+            double local_max = 0.0, global_max_diff;
+            for (int s = 1; s < nt; s++) {
+                wait_for(&progress[s * PAD], MAX_ITER);
+            }
+            for (int s = 0; s < nt; s++) {
+                if (thread_diff[s * PAD][(MAX_ITER - 1) % 2] > local_max) {
+                    local_max = thread_diff[s * PAD][(MAX_ITER - 1) % 2];
+                }
+            }
+            MPI_Allreduce(&local_max, &global_max_diff, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            if (global_max_diff < TOLERANCE) {
+                atomic_store(&stop_iter, MAX_ITER - 1);
+            }
+        }
+    }
+
+    // Check for convergence
+    if (rank == 0) {
+        int converged = atomic_load(&stop_iter);
+        if (converged >= 0) {
+            printf("Converged after %d iterations.\n", converged);
+        }
+    }
+
+    // End timing
+    end_time = MPI_Wtime();
+    if (rank == 0) {
+        printf("Persistent-region execution time: %f seconds (%d threads per process)\n",
+               end_time - start_time, nthreads);
+    }
+
+    // Free memory
+    for (int b = 0; b < 2; b++) {
+        for (i = 0; i < NX; i++) {
+            free(buf[b][i]);
+        }
+        free(buf[b]);
+    }
+    free(send_buf);
+    free(recv_buf);
+
+    MPI_Finalize();
+    return 0;
+}
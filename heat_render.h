@@ -0,0 +1,271 @@
+#ifndef HEAT_RENDER_H
+#define HEAT_RENDER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Colormapped images with no external libraries: 256-entry colormap LUTs and
+// PPM/PNG writers.
+//
+// The PNG encoder is a "deflate-lite": one fixed-Huffman deflate block with
+// greedy LZ77 matching through a single-probe hash table, inside a zlib
+// stream. Each row gets the PNG filter (none, sub, up or Paeth) with the
+// smallest sum of absolute residuals. Smooth temperature fields compress well
+// this way without the cost of building Huffman tables per image.
+
+#define HEAT_LZ_HASH_BITS 15
+#define HEAT_LZ_WINDOW 32768
+#define HEAT_LZ_MAX_MATCH 258
+
+typedef struct {
+    unsigned char rgb[256][3];
+} heat_colormap_t;
+
+// Piecewise-linear colormaps; returns -1 for an unknown name
+static inline int heat_colormap(const char *name, heat_colormap_t *cm) {
+    static const struct { const char *name; int n; double pts[6][4]; } maps[] = {
+        { "hot", 4, { { 0.0, 0, 0, 0 }, { 0.365, 255, 0, 0 }, { 0.746, 255, 255, 0 }, { 1.0, 255, 255, 255 } } },
+        { "inferno", 6, { { 0.0, 0, 0, 4 }, { 0.2, 50, 10, 94 }, { 0.4, 120, 28, 109 },
+                          { 0.6, 188, 55, 84 }, { 0.8, 249, 142, 9 }, { 1.0, 252, 255, 164 } } },
+        { "coolwarm", 3, { { 0.0, 59, 76, 192 }, { 0.5, 221, 221, 221 }, { 1.0, 180, 4, 38 } } },
+        { "gray", 2, { { 0.0, 0, 0, 0 }, { 1.0, 255, 255, 255 } } },
+    };
+    for (size_t m = 0; m < sizeof(maps) / sizeof(maps[0]); m++) {
+        if (strcmp(name, maps[m].name) != 0) continue;
+        for (int k = 0, p = 0; k < 256; k++) {
+            double t = k / 255.0;
+            while (p < maps[m].n - 2 && t > maps[m].pts[p + 1][0]) p++;
+            const double *a = maps[m].pts[p], *b = maps[m].pts[p + 1];
+            double w = (t - a[0]) / (b[0] - a[0]);
+            w = (w < 0.0) ? 0.0 : (w > 1.0) ? 1.0 : w;
+            for (int c = 0; c < 3; c++) {
+                cm->rgb[k][c] = (unsigned char)(a[c + 1] + w * (b[c + 1] - a[c + 1]) + 0.5);
+            }
+        }
+        return 0;
+    }
+    return -1;
+}
+
+// LUT index of a value on the scale [lo, hi]; NaN maps to the bottom
+static inline int heat_colormap_index(double v, double lo, double scale) {
+    double x = (v - lo) * scale;
+    return (x > 0.0) ? ((x < 255.0) ? (int)(x + 0.5) : 255) : 0;
+}
+
+static inline int heat_ppm_write(const char *path, const unsigned char *rgb, int w, int h) {
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL) return -1;
+    fprintf(fp, "P6\n%d %d\n255\n", w, h);
+    size_t n = fwrite(rgb, 3, (size_t)w * h, fp);
+    return (fclose(fp) == 0 && n == (size_t)w * h) ? 0 : -1;
+}
+
+// Growable byte buffer with an LSB-first bit writer, as deflate wants
+typedef struct {
+    unsigned char *data;
+    size_t len, cap;
+    uint32_t bits;
+    int nbits;
+} heat_bitbuf_t;
+
+static inline void heat_put_byte(heat_bitbuf_t *b, unsigned char c) {
+    if (b->len == b->cap) {
+        b->cap = (b->cap > 0) ? 2 * b->cap : 65536;
+        b->data = (unsigned char *)realloc(b->data, b->cap);
+    }
+    b->data[b->len++] = c;
+}
+
+static inline void heat_put_bits(heat_bitbuf_t *b, uint32_t value, int n) {
+    b->bits |= value << b->nbits;
+    b->nbits += n;
+    while (b->nbits >= 8) {
+        heat_put_byte(b, b->bits & 0xff);
+        b->bits >>= 8;
+        b->nbits -= 8;
+    }
+}
+
+// Huffman codes are sent most significant bit first
+static inline void heat_put_code(heat_bitbuf_t *b, uint32_t code, int len) {
+    uint32_t r = 0;
+    for (int i = 0; i < len; i++) r = (r << 1) | ((code >> i) & 1);
+    heat_put_bits(b, r, len);
+}
+
+// Fixed Huffman code of a literal/length symbol (RFC 1951, 3.2.6)
+static inline void heat_put_symbol(heat_bitbuf_t *b, int sym) {
+    if (sym < 144) heat_put_code(b, 0x30 + sym, 8);
+    else if (sym < 256) heat_put_code(b, 0x190 + sym - 144, 9);
+    else if (sym < 280) heat_put_code(b, sym - 256, 7);
+    else heat_put_code(b, 0xc0 + sym - 280, 8);
+}
+
+static inline void heat_put_match(heat_bitbuf_t *b, int len, int dist) {
+    static const short len_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const unsigned char len_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                                 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const unsigned short dist_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                                  193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+                                                  4097, 6145, 8193, 12289, 16385, 24577 };
+    int k = 28, d = 29;
+    while (len < len_base[k]) k--;
+    heat_put_symbol(b, 257 + k);
+    heat_put_bits(b, len - len_base[k], len_extra[k]);
+    while (dist < dist_base[d]) d--;
+    heat_put_code(b, d, 5);
+    heat_put_bits(b, dist - dist_base[d], d < 4 ? 0 : d / 2 - 1);
+}
+
+// zlib stream of src: one fixed-Huffman block, greedy LZ77
+static inline void heat_deflate_lite(heat_bitbuf_t *b, const unsigned char *src, size_t n) {
+    int32_t *head = (int32_t *)malloc(sizeof(int32_t) << HEAT_LZ_HASH_BITS);
+    uint32_t s1 = 1, s2 = 0;
+    size_t i = 0;
+
+    memset(head, 0xff, sizeof(int32_t) << HEAT_LZ_HASH_BITS);
+    heat_put_byte(b, 0x78);
+    heat_put_byte(b, 0x01);
+    heat_put_bits(b, 1, 1);     // BFINAL
+    heat_put_bits(b, 1, 2);     // BTYPE = fixed Huffman
+
+#define HEAT_LZ_HASH(p) ((((uint32_t)(p)[0] << 16 | (uint32_t)(p)[1] << 8 | (p)[2]) * 2654435761u) >> (32 - HEAT_LZ_HASH_BITS))
+    while (i < n) {
+        size_t best = 0, dist = 0;
+        if (i + 3 <= n) {
+            uint32_t h = HEAT_LZ_HASH(src + i);
+            int32_t cand = head[h];
+            head[h] = (int32_t)i;
+            if (cand >= 0 && i - (size_t)cand <= HEAT_LZ_WINDOW) {
+                size_t max = (n - i < HEAT_LZ_MAX_MATCH) ? n - i : HEAT_LZ_MAX_MATCH;
+                while (best < max && src[cand + best] == src[i + best]) best++;
+                dist = i - (size_t)cand;
+            }
+        }
+        if (best >= 3) {
+            heat_put_match(b, (int)best, (int)dist);
+            for (size_t k = 1; k < best && i + k + 3 <= n; k++) {
+                head[HEAT_LZ_HASH(src + i + k)] = (int32_t)(i + k);
+            }
+            i += best;
+        } else {
+            heat_put_symbol(b, src[i]);
+            i++;
+        }
+    }
+#undef HEAT_LZ_HASH
+    heat_put_symbol(b, 256);
+    if (b->nbits > 0) heat_put_bits(b, 0, 8 - b->nbits);
+
+    // Adler-32, reduced often enough not to overflow
+    for (i = 0; i < n; ) {
+        size_t end = (n - i > 5552) ? i + 5552 : n;
+        for (; i < end; i++) {
+            s1 += src[i];
+            s2 += s1;
+        }
+        s1 %= 65521;
+        s2 %= 65521;
+    }
+    uint32_t adler = s2 << 16 | s1;
+    for (int k = 3; k >= 0; k--) heat_put_byte(b, (adler >> (8 * k)) & 0xff);
+    free(head);
+}
+
+static inline uint32_t heat_crc32(uint32_t crc, const unsigned char *p, size_t n) {
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t k = 0; k < 256; k++) {
+            uint32_t c = k;
+            for (int j = 0; j < 8; j++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[k] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static inline void heat_png_chunk(FILE *fp, const char *type, const unsigned char *data, size_t len) {
+    unsigned char be[4] = { (unsigned char)(len >> 24), (unsigned char)(len >> 16),
+                            (unsigned char)(len >> 8), (unsigned char)len };
+    fwrite(be, 1, 4, fp);
+    fwrite(type, 1, 4, fp);
+    if (len > 0) fwrite(data, 1, len, fp);
+    uint32_t crc = heat_crc32(heat_crc32(0, (const unsigned char *)type, 4), data, len);
+    unsigned char c[4] = { (unsigned char)(crc >> 24), (unsigned char)(crc >> 16),
+                           (unsigned char)(crc >> 8), (unsigned char)crc };
+    fwrite(c, 1, 4, fp);
+}
+
+static inline int heat_paeth(int a, int b, int c) {
+    int p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
+}
+
+// 8-bit RGB PNG
+static inline int heat_png_write(const char *path, const unsigned char *rgb, int w, int h) {
+    const size_t stride = (size_t)w * 3;
+    unsigned char *raw = (unsigned char *)malloc((stride + 1) * h);
+    unsigned char *cand = (unsigned char *)malloc(4 * stride);
+
+    // Per-row filter with the smallest sum of |residual|
+    for (int y = 0; y < h; y++) {
+        const unsigned char *row = rgb + y * stride, *up = (y > 0) ? row - stride : NULL;
+        long best_sum = -1;
+        int best = 0;
+        for (int f = 0; f < 4; f++) {
+            unsigned char *out = cand + f * stride;
+            long sum = 0;
+            for (size_t x = 0; x < stride; x++) {
+                int a = (x >= 3) ? row[x - 3] : 0, b = up ? up[x] : 0, c = (up && x >= 3) ? up[x - 3] : 0;
+                int pred = (f == 0) ? 0 : (f == 1) ? a : (f == 2) ? b : heat_paeth(a, b, c);
+                out[x] = (unsigned char)(row[x] - pred);
+                sum += (out[x] < 128) ? out[x] : 256 - out[x];
+            }
+            if (best_sum < 0 || sum < best_sum) {
+                best_sum = sum;
+                best = f;
+            }
+        }
+        static const unsigned char png_filter[4] = { 0, 1, 2, 4 };    // none, sub, up, Paeth
+        raw[y * (stride + 1)] = png_filter[best];
+        memcpy(raw + y * (stride + 1) + 1, cand + best * stride, stride);
+    }
+    free(cand);
+
+    heat_bitbuf_t z = { NULL, 0, 0, 0, 0 };
+    heat_deflate_lite(&z, raw, (stride + 1) * h);
+    free(raw);
+
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL) {
+        free(z.data);
+        return -1;
+    }
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    unsigned char ihdr[13] = { (unsigned char)(w >> 24), (unsigned char)(w >> 16), (unsigned char)(w >> 8),
+                               (unsigned char)w, (unsigned char)(h >> 24), (unsigned char)(h >> 16),
+                               (unsigned char)(h >> 8), (unsigned char)h, 8, 2, 0, 0, 0 };
+    fwrite(signature, 1, 8, fp);
+    heat_png_chunk(fp, "IHDR", ihdr, sizeof(ihdr));
+    heat_png_chunk(fp, "IDAT", z.data, z.len);
+    heat_png_chunk(fp, "IEND", NULL, 0);
+    free(z.data);
+    return (fclose(fp) == 0) ? 0 : -1;
+}
+
+// PPM if the name ends in .ppm, PNG otherwise
+static inline int heat_image_write(const char *path, const unsigned char *rgb, int w, int h) {
+    size_t len = strlen(path);
+    if (len > 4 && strcmp(path + len - 4, ".ppm") == 0) {
+        return heat_ppm_write(path, rgb, w, h);
+    }
+    return heat_png_write(path, rgb, w, h);
+}
+
+#endif
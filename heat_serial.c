@@ -2,73 +2,65 @@
 #include <stdlib.h>
 #include <math.h>
 #include <time.h>
+#include "libheat.h"
 
 #define NX 500
 #define NY 500
 #define MAX_ITER 1000
 #define TOLERANCE 1e-6
 
-int main() {
-    double u[NX][NY], u_new[NX][NY];
-    int i, j, iter;
-    double diff, max_diff;
+// Serial driver for libheat
+int main(int argc, char **argv) {
+    heat_options_t opts;
+    heat_solver_t *solver;
+    int iter;
     clock_t start, end;
     double cpu_time_used;
 
+    // Boundary conditions and source term (optional config file argument)
+    heat_options_default(&opts, NX, NY);
+    if (argc > 1) {
+        if (heat_config_load(argv[1], &opts.config) != 0) {
+            return 1;
+        }
+        heat_config_print(&opts.config);
+    }
+
     // Start timing
     start = clock();
 
-    // Initialize the grid
-    for (i = 0; i < NX; i++) {
-        for (j = 0; j < NY; j++) {
-            u[i][j] = 0.0;
-            if (i == 0 || i == NX - 1 || j == 0 || j == NY - 1) {
-                u[i][j] = 100.0; // Boundary conditions
-            }
-        }
+    solver = heat_create(&opts);
+    if (solver == NULL) {
+        return 1;
     }
 
-    // Iterative solver
-    for (iter = 0; iter < MAX_ITER; iter++) {
-        max_diff = 0.0;
+    // Live metrics for heat_top when HEAT_TELEMETRY names the run
+    heat_enable_telemetry(solver, getenv("HEAT_TELEMETRY"), getenv("HEAT_TELEMETRY_PROM"));
 
-        for (i = 1; i < NX - 1; i++) {
-            for (j = 1; j < NY - 1; j++) {
-                u_new[i][j] = 0.25 * (u[i+1][j] + u[i-1][j]
-                                     + u[i][j+1] + u[i][j-1]);
-                diff = fabs(u_new[i][j] - u[i][j]);
-                if (diff > max_diff) {
-                    max_diff = diff;
-                }
-            }
-        }
+    // In-situ frames when HEAT_RENDER names a file pattern (frame_%06d.png)
+    if (heat_enable_render(solver, getenv("HEAT_RENDER"), getenv("HEAT_RENDER_OPTIONS")) != 0) {
+        heat_destroy(solver);
+        return 1;
+    }
 
-        // Update u
-        for (i = 1; i < NX - 1; i++) {
-            for (j = 1; j < NY - 1; j++) {
-                u[i][j] = u_new[i][j];
-            }
-        }
+    // Fused analytics time series when HEAT_ANALYTICS names a CSV file
+    if (heat_enable_analytics(solver, getenv("HEAT_ANALYTICS"), getenv("HEAT_ANALYTICS_OPTIONS")) != 0) {
+        heat_destroy(solver);
+        return 1;
+    }
 
-        // Check for convergence
-        if (max_diff < TOLERANCE) {
-            printf("Converged after %d iterations.\n", iter);
-            break;
-        }
+    // Iterative solver
+    iter = heat_solve(solver, MAX_ITER, TOLERANCE);
+    if (iter >= 0) {
+        printf("Converged after %d iterations.\n", iter);
     }
 
     // End timing
     end = clock();
     cpu_time_used = ((double) (end - start)) / CLOCKS_PER_SEC;
     printf("Serial execution time: %f seconds\n", cpu_time_used);
+    heat_memory_report(solver, stdout);
 
-    // Output result (optional)
-    // for (i = 0; i < NX; i++) {
-    //    for (j = 0; j < NY; j++) {
-    //        printf("%f ", u[i][j]);
-    //    }
-    //    printf("\n");
-    // }
-
+    heat_destroy(solver);
     return 0;
 }
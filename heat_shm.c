@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+#include "heat_config.h"
+
+#define NX 500
+#define NY 500
+#define MAX_ITER 1000
+#define TOLERANCE 1e-6
+
+// Hybrid MPI+OpenMP solver with zero-copy halos between ranks on one node.
+//
+//   mpirun -np P ./heat_shm [ranks_per_node]
+//
+// Ranks on the same node (MPI_Comm_split_type) allocate their two grid buffers
+// in one MPI_Win_allocate_shared window. A neighbour on the same node reads the
+// edge column straight out of the other rank's buffer; only neighbours on other
+// nodes exchange messages. Buffers alternate each iteration (read u[it % 2],
+// write u[(it + 1) % 2]), so the per-iteration convergence Allreduce, bracketed
+// by MPI_Win_sync, is all the synchronization needed: after it, every
+// neighbour has finished writing the buffer we read and finished reading the
+// buffer we are about to write.
+//
+// The optional argument caps the ranks sharing a window, which emulates
+// smaller nodes for testing the mixed path on one machine.
+
+// Local columns of rank r, including the two ghost columns
+static int local_columns(int r, int size) {
+    int local_ny = (NY - 2) / size;
+    int start_y = r * local_ny + 1;
+    int end_y = (r == size - 1) ? (NY - 1) : (start_y + local_ny);
+    return end_y - start_y + 2;
+}
+
+// Base of rank `world_rank`'s window segment, or NULL if it is not on our node
+static double *neighbour_segment(MPI_Win win, MPI_Comm node_comm, int world_rank) {
+    MPI_Group world_group, node_group;
+    int node_rank, disp_unit;
+    MPI_Aint seg_size;
+    double *base;
+
+    if (world_rank == MPI_PROC_NULL) return NULL;
+    MPI_Comm_group(MPI_COMM_WORLD, &world_group);
+    MPI_Comm_group(node_comm, &node_group);
+    MPI_Group_translate_ranks(world_group, 1, &world_rank, node_group, &node_rank);
+    MPI_Group_free(&world_group);
+    MPI_Group_free(&node_group);
+    if (node_rank == MPI_UNDEFINED) return NULL;
+    MPI_Win_shared_query(win, node_rank, &seg_size, &disp_unit, &base);
+    return base;
+}
+
+// Fill ghost column `dst` from a neighbour: directly from its buffer if it
+// shares our node, else by message
+static void halo_from(double **u, int dst, const double *shared_col, int stride,
+                      double *send_buf, double *recv_buf, int src_col,
+                      int peer, int tag) {
+    int i;
+    if (shared_col != NULL) {
+        for (i = 0; i < NX; i++) u[i][dst] = shared_col[(long)i * stride];
+        return;
+    }
+    if (peer == MPI_PROC_NULL) return;
+    for (i = 0; i < NX; i++) send_buf[i] = u[i][src_col];
+    MPI_Sendrecv(send_buf, NX, MPI_DOUBLE, peer, tag,
+                 recv_buf, NX, MPI_DOUBLE, peer, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    for (i = 0; i < NX; i++) u[i][dst] = recv_buf[i];
+}
+
+int main(int argc, char **argv) {
+    double *rows[2][NX];
+    double *send_buf, *recv_buf, *base;
+    int i, j, b, iter;
+    double max_diff, global_max_diff;
+    int rank, size, node_rank, node_size;
+    double start_time, end_time;
+    MPI_Comm node_comm;
+    MPI_Win win;
+
+    // Initialize MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Ranks that can share memory, optionally split into smaller groups
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+    if (argc > 1 && atoi(argv[1]) > 0) {
+        MPI_Comm group_comm;
+        MPI_Comm_rank(node_comm, &node_rank);
+        MPI_Comm_split(node_comm, node_rank / atoi(argv[1]), node_rank, &group_comm);
+        MPI_Comm_free(&node_comm);
+        node_comm = group_comm;
+    }
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_size(node_comm, &node_size);
+
+    // Start timing
+    start_time = MPI_Wtime();
+
+    // Divide the domain among processes (column-wise decomposition)
+    int local_ny = (NY - 2) / size;
+    int start_y = rank * local_ny + 1;
+    int actual_ny = local_columns(rank, size);
+    int left = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
+    int right = (rank < size - 1) ? rank + 1 : MPI_PROC_NULL;
+
+    // Both buffers in this rank's segment of the node window; each segment
+    // stays local to its rank's NUMA domain
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "alloc_shared_noncontig", "true");
+    MPI_Win_allocate_shared((MPI_Aint)2 * NX * actual_ny * sizeof(double), sizeof(double),
+                            info, node_comm, &base, &win);
+    MPI_Info_free(&info);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+    for (b = 0; b < 2; b++) {
+        for (i = 0; i < NX; i++) {
+            rows[b][i] = base + ((long)b * NX + i) * actual_ny;
+        }
+    }
+
+    // Neighbour segments on this node; their edge columns are read in place
+    double *left_base = neighbour_segment(win, node_comm, left);
+    double *right_base = neighbour_segment(win, node_comm, right);
+    int left_ny = (left != MPI_PROC_NULL) ? local_columns(left, size) : 0;
+    int right_ny = (right != MPI_PROC_NULL) ? local_columns(right, size) : 0;
+    send_buf = (double *)malloc(NX * sizeof(double));
+    recv_buf = (double *)malloc(NX * sizeof(double));
+
+    // Initialize both buffers
+    #pragma omp parallel for private(i, j, b) collapse(2)
+    for (i = 0; i < NX; i++) {
+        for (j = 0; j < actual_ny; j++) {
+            int global_j = start_y + j - 1;
+            double v = 0.0;
+            if (i == 0 || i == NX - 1 || global_j == 0 || global_j == NY - 1) {
+                v = 100.0;
+            }
+            for (b = 0; b < 2; b++) rows[b][i][j] = v;
+        }
+    }
+    MPI_Win_sync(win);
+    MPI_Barrier(node_comm);
+    MPI_Win_sync(win);
+
+    // Iterative solver
+    for (iter = 0; iter < MAX_ITER; iter++) {
+        double **u = rows[iter % 2], **u_new = rows[(iter + 1) % 2];
+        long offset = (long)(iter % 2) * NX;
+
+        // Ghost columns: last owned column of the left neighbour, first of the right.
+        // Message pairs are ordered by rank parity so blocking Sendrecv cannot deadlock.
+        const double *left_col = left_base ? left_base + offset * left_ny + (left_ny - 2) : NULL;
+        const double *right_col = right_base ? right_base + offset * right_ny + 1 : NULL;
+        if (rank % 2 == 0) {
+            halo_from(u, actual_ny - 1, right_col, right_ny, send_buf, recv_buf, actual_ny - 2, right, 0);
+            halo_from(u, 0, left_col, left_ny, send_buf, recv_buf, 1, left, 0);
+        } else {
+            halo_from(u, 0, left_col, left_ny, send_buf, recv_buf, 1, left, 0);
+            halo_from(u, actual_ny - 1, right_col, right_ny, send_buf, recv_buf, actual_ny - 2, right, 0);
+        }
+
+        // Compute new values using OpenMP
+        max_diff = heat_sweep_plain(u, u_new, NULL, 0, 1, NX - 1, 1, actual_ny - 1);
+
+        // Global reduction; also publishes this iteration's buffer to the node
+        MPI_Win_sync(win);
+        MPI_Allreduce(&max_diff, &global_max_diff, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        MPI_Win_sync(win);
+
+        // Check for convergence
+        if (global_max_diff < TOLERANCE) {
+            if (rank == 0) {
+                printf("Converged after %d iterations.\n", iter);
+            }
+            break;
+        }
+    }
+
+    // End timing
+    end_time = MPI_Wtime();
+
+    double **u = rows[(iter < MAX_ITER ? iter + 1 : MAX_ITER) % 2];
+    double local_sum = 0.0, sum;
+    int links[2] = { (left_base != NULL) + (right_base != NULL),
+                     (left != MPI_PROC_NULL) + (right != MPI_PROC_NULL) }, total[2];
+    for (i = 1; i < NX - 1; i++) {
+        for (j = 1; j < actual_ny - 1; j++) {
+            local_sum += u[i][j];
+        }
+    }
+    MPI_Reduce(&local_sum, &sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(links, total, 2, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        printf("Shared-memory halos: %d of %d neighbour links\n", total[0], total[1]);
+        printf("Average interior temperature: %.6f\n", sum / ((double)(NX - 2) * (NY - 2)));
+        printf("Shared-memory execution time: %f seconds\n", end_time - start_time);
+    }
+
+    // Free memory
+    MPI_Win_unlock_all(win);
+    MPI_Win_free(&win);
+    MPI_Comm_free(&node_comm);
+    free(send_buf);
+    free(recv_buf);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+#include "heat_stencil.h"
+
+#define NX 500
+#define NY 500
+#define MAX_ITER 1000
+#define TOLERANCE 1e-6
+
+// Hybrid MPI+OpenMP solver driven by the compile-time stencil engine.
+//
+//   mpirun -np P ./heat_stencil [5pt|9pt|wide4|aniso]
+//
+// The ghost width follows the stencil radius R: the outer R lines of the
+// grid hold the Dirichlet boundary and each rank exchanges R ghost columns.
+
+static const stencil_t *stencils[] = { &stencil_5pt, &stencil_9pt, &stencil_wide4, &stencil_aniso };
+
+int main(int argc, char **argv) {
+    double **u, **u_new;
+    double *send_buf, *recv_buf;
+    int i, j, r, iter;
+    double max_diff, global_max_diff;
+    int rank, size;
+    int local_ny, start_y, end_y;
+    double start_time, end_time;
+    const stencil_t *st = &stencil_5pt;
+
+    // Initialize MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc > 1) {
+        st = NULL;
+        for (size_t s = 0; s < sizeof(stencils) / sizeof(stencils[0]); s++) {
+            if (strcmp(argv[1], stencils[s]->name) == 0) st = stencils[s];
+        }
+        if (st == NULL) {
+            if (rank == 0) {
+                fprintf(stderr, "Usage: %s [5pt|9pt|wide4|aniso]\n", argv[0]);
+            }
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    const int R = stencil_radius(st);
+
+    // Start timing
+    start_time = MPI_Wtime();
+
+    // Divide the interior columns R..NY-R-1 among processes
+    local_ny = (NY - 2 * R) / size;
+    start_y = rank * local_ny + R;
+    end_y = (rank == size - 1) ? (NY - R) : (start_y + local_ny);
+
+    // Local arrays with R ghost columns on each side; global j = start_y + j - R
+    int actual_ny = end_y - start_y + 2 * R;
+    u = (double **)malloc(NX * sizeof(double *));
+    u_new = (double **)malloc(NX * sizeof(double *));
+    for (i = 0; i < NX; i++) {
+        u[i] = (double *)malloc(actual_ny * sizeof(double));
+        u_new[i] = (double *)malloc(actual_ny * sizeof(double));
+    }
+    send_buf = (double *)malloc((size_t)NX * R * sizeof(double));
+    recv_buf = (double *)malloc((size_t)NX * R * sizeof(double));
+    int left = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
+    int right = (rank < size - 1) ? rank + 1 : MPI_PROC_NULL;
+
+    // Initialize local grid: the outer R lines are boundary
+    for (i = 0; i < NX; i++) {
+        for (j = 0; j < actual_ny; j++) {
+            int global_j = start_y + j - R;
+            u[i][j] = 0.0;
+            if (i < R || i >= NX - R || global_j < R || global_j >= NY - R) {
+                u[i][j] = 100.0;
+            }
+            u_new[i][j] = u[i][j];
+        }
+    }
+
+    // Iterative solver
+    for (iter = 0; iter < MAX_ITER; iter++) {
+        // Exchange R ghost columns with each neighbour
+        for (i = 0; i < NX; i++)
+            for (r = 0; r < R; r++) send_buf[i * R + r] = u[i][R + r];
+        MPI_Sendrecv(send_buf, NX * R, MPI_DOUBLE, left, 0,
+                     recv_buf, NX * R, MPI_DOUBLE, right, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        if (right != MPI_PROC_NULL) {
+            for (i = 0; i < NX; i++)
+                for (r = 0; r < R; r++) u[i][actual_ny - R + r] = recv_buf[i * R + r];
+        }
+        for (i = 0; i < NX; i++)
+            for (r = 0; r < R; r++) send_buf[i * R + r] = u[i][actual_ny - 2 * R + r];
+        MPI_Sendrecv(send_buf, NX * R, MPI_DOUBLE, right, 1,
+                     recv_buf, NX * R, MPI_DOUBLE, left, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        if (left != MPI_PROC_NULL) {
+            for (i = 0; i < NX; i++)
+                for (r = 0; r < R; r++) u[i][r] = recv_buf[i * R + r];
+        }
+
+        // Compute new values with the selected stencil
+        max_diff = st->sweep(u, u_new, R, NX - R, R, actual_ny - R);
+
+        // Update u using OpenMP
+        #pragma omp parallel for private(i, j) collapse(2)
+        for (i = R; i < NX - R; i++) {
+            for (j = R; j < actual_ny - R; j++) {
+                u[i][j] = u_new[i][j];
+            }
+        }
+
+        // Global reduction to find maximum difference
+        MPI_Allreduce(&max_diff, &global_max_diff, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+        // Check for convergence
+        if (global_max_diff < TOLERANCE) {
+            if (rank == 0) {
+                printf("Converged after %d iterations.\n", iter);
+            }
+            break;
+        }
+    }
+
+    // End timing
+    end_time = MPI_Wtime();
+
+    double local_sum = 0.0, sum;
+    for (i = R; i < NX - R; i++) {
+        for (j = R; j < actual_ny - R; j++) {
+            local_sum += u[i][j];
+        }
+    }
+    MPI_Reduce(&local_sum, &sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        printf("Stencil: %s (halo width %d)\n", st->name, R);
+        printf("Average interior temperature: %.6f\n", sum / ((double)(NX - 2 * R) * (NY - 2 * R)));
+        printf("Stencil execution time: %f seconds\n", end_time - start_time);
+    }
+
+    // Free memory
+    for (i = 0; i < NX; i++) {
+        free(u[i]);
+        free(u_new[i]);
+    }
+    free(u);
+    free(u_new);
+    free(send_buf);
+    free(recv_buf);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,157 @@
+#ifndef HEAT_STENCIL_H
+#define HEAT_STENCIL_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <math.h>
+
+// Compile-time stencil engine.
+//
+// A stencil is a constant table of (di, dj, coefficient) points of the
+// discrete operator, plus the centre coefficient and a Jacobi damping factor.
+// HEAT_DEFINE_STENCIL instantiates a sweep function per stencil from one
+// always_inline body. The table is a compile-time constant, so the compiler
+// fully unrolls the loop over points and folds the coefficients into the
+// inner j loop, which stays a plain SIMD-friendly loop. The halo width
+// callers need is the stencil radius, max(|di|, |dj|) over the table.
+//
+// stencil_5pt below is the Jacobi kernel of the whole tree: libheat's
+// heat_sweep_row (heat_config.h) and the CPU drivers call its row or sweep
+// function instead of keeping their own copy of the update.
+
+typedef struct {
+    int di, dj;
+    double c;
+} stencil_point_t;
+
+typedef double (*stencil_sweep_fn)(double **u, double **u_new, int i0, int i1, int j0, int j1);
+
+typedef struct {
+    const char *name;
+    const stencil_point_t *points;
+    int npts;
+    stencil_sweep_fn sweep;
+} stencil_t;
+
+// Halo width required by the stencil: the largest offset in its table
+static inline int stencil_radius(const stencil_t *st) {
+    int r = 0;
+    for (int p = 0; p < st->npts; p++) {
+        int di = abs(st->points[p].di), dj = abs(st->points[p].dj);
+        if (di > r) r = di;
+        if (dj > r) r = dj;
+    }
+    return r;
+}
+
+// Damped Jacobi update of row i, columns [j0, j1):
+// u_new = (1 - omega) * u + omega * (-(sum_p c_p u_p + f) / c_center)
+// f is the source row, read only when has_source, which like the table is a
+// compile-time constant at every call site.
+static inline __attribute__((always_inline))
+double stencil_row(double **u, double **u_new, int i, int j0, int j1,
+                   const stencil_point_t *pts, const int npts,
+                   const double center, const double omega,
+                   const double *f, const int has_source) {
+    const double *rows[16];
+    const double *mid = u[i];
+    double *out = u_new[i];
+    const double scale = -1.0 / center;
+    double diff, max_diff = 0.0;
+    int j, p;
+
+    #pragma GCC unroll 16
+    for (p = 0; p < npts; p++) {
+        rows[p] = u[i + pts[p].di] + pts[p].dj;
+    }
+#ifdef _OPENMP
+    #pragma omp simd reduction(max:max_diff)
+#endif
+    for (j = j0; j < j1; j++) {
+        double acc = pts[0].c * rows[0][j];
+        #pragma GCC unroll 16
+        for (p = 1; p < npts; p++) {
+            acc += pts[p].c * rows[p][j];
+        }
+        if (has_source) acc += f[j];
+        double v = acc * scale;
+        if (omega != 1.0) {
+            v = (1.0 - omega) * mid[j] + omega * v;
+        }
+        out[j] = v;
+        diff = fabs(v - mid[j]);
+        max_diff = (diff > max_diff) ? diff : max_diff;
+    }
+    return max_diff;
+}
+
+// libheat.h pulls this header into C++ code as well
+#ifdef __cplusplus
+#define STENCIL_STATIC_ASSERT static_assert
+#else
+#define STENCIL_STATIC_ASSERT _Static_assert
+#endif
+
+#ifdef _OPENMP
+#define STENCIL_OMP_FOR _Pragma("omp parallel for reduction(max:max_diff)")
+#else
+#define STENCIL_OMP_FOR
+#endif
+
+// Instantiate a stencil: NAME_row, NAME_sweep and the descriptor NAME.
+// NAME_row updates one row (source f indexed f[i * f_stride + j]) for callers
+// that schedule rows themselves; NAME_sweep shares rows [i0, i1) among
+// threads. The parallel loop lives in each instantiation so the row kernel is
+// specialized inside it.
+#define HEAT_DEFINE_STENCIL(NAME, LABEL, CENTER, OMEGA, ...)                         \
+    static const stencil_point_t NAME##_points[] = { __VA_ARGS__ };                  \
+    STENCIL_STATIC_ASSERT(sizeof(NAME##_points) / sizeof(NAME##_points[0]) <= 16,    \
+                          "stencil has more than 16 points");                        \
+    static inline __attribute__((always_inline))                                     \
+    double NAME##_row(double **u, double **u_new, const double *f, int f_stride,     \
+                      int i, int j0, int j1, const int has_source) {                 \
+        return stencil_row(u, u_new, i, j0, j1, NAME##_points,                       \
+            (int)(sizeof(NAME##_points) / sizeof(NAME##_points[0])), CENTER, OMEGA,  \
+            has_source ? f + (long)i * f_stride : NULL, has_source);                 \
+    }                                                                                \
+    static double NAME##_sweep(double **u, double **u_new,                           \
+                               int i0, int i1, int j0, int j1) {                     \
+        double max_diff = 0.0;                                                       \
+        STENCIL_OMP_FOR                                                              \
+        for (int i = i0; i < i1; i++) {                                              \
+            double d = NAME##_row(u, u_new, NULL, 0, i, j0, j1, 0);                  \
+            max_diff = (d > max_diff) ? d : max_diff;                                \
+        }                                                                            \
+        return max_diff;                                                             \
+    }                                                                                \
+    static const stencil_t NAME = { LABEL, NAME##_points,                              \
+        (int)(sizeof(NAME##_points) / sizeof(NAME##_points[0])), NAME##_sweep };
+
+// Anisotropic weights for u_xx (along i) and u_yy (along j)
+#ifndef ANISO_KX
+#define ANISO_KX 1.0
+#endif
+#ifndef ANISO_KY
+#define ANISO_KY 0.25
+#endif
+
+// Standard 5-point Laplacian (same operation order as the hand-written kernels)
+HEAT_DEFINE_STENCIL(stencil_5pt, "5pt", -4.0, 1.0,
+    { 1, 0, 1.0 }, { -1, 0, 1.0 }, { 0, 1, 1.0 }, { 0, -1, 1.0 })
+
+// 9-point compact (Mehrstellen) Laplacian, fourth order for Laplace's equation
+HEAT_DEFINE_STENCIL(stencil_9pt, "9pt", -20.0, 1.0,
+    { 1, 0, 4.0 }, { -1, 0, 4.0 }, { 0, 1, 4.0 }, { 0, -1, 4.0 },
+    { 1, 1, 1.0 }, { 1, -1, 1.0 }, { -1, 1, 1.0 }, { -1, -1, 1.0 })
+
+// Fourth-order wide Laplacian (-1, 16, -30, 16, -1) / 12 in each direction.
+// Plain Jacobi diverges on its highest modes; damping by 0.8 restores convergence.
+HEAT_DEFINE_STENCIL(stencil_wide4, "wide4", -60.0, 0.8,
+    { 1, 0, 16.0 }, { -1, 0, 16.0 }, { 0, 1, 16.0 }, { 0, -1, 16.0 },
+    { 2, 0, -1.0 }, { -2, 0, -1.0 }, { 0, 2, -1.0 }, { 0, -2, -1.0 })
+
+// Anisotropic 5-point operator ANISO_KX * u_xx + ANISO_KY * u_yy
+HEAT_DEFINE_STENCIL(stencil_aniso, "aniso", -2.0 * (ANISO_KX + ANISO_KY), 1.0,
+    { 1, 0, ANISO_KX }, { -1, 0, ANISO_KX }, { 0, 1, ANISO_KY }, { 0, -1, ANISO_KY })
+
+#endif
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <omp.h>
+
+#include "heat_stencil.h"
+
+#define NX 500
+#define NY 500
+#define MAX_ITER 1000
+#define TOLERANCE 1e-6
+#define TILE_X 64
+#define TILE_Y 64
+
+// Number of grid buffers in the ring. Tiles may run up to NBUF - 1
+// iterations ahead of the oldest unfinished one.
+#define NBUF 4
+
+#define TILES_X ((NX - 2 + TILE_X - 1) / TILE_X)
+#define TILES_Y ((NY - 2 + TILE_Y - 1) / TILE_Y)
+#define NTILES (TILES_X * TILES_Y)
+
+// Task-based dataflow Jacobi solver. Each tile update at iteration k is an
+// OpenMP task that depends only on its own tile and its four neighbour tiles
+// at iteration k-1, so there is no barrier between iterations.
+
+typedef double grid_t[NY];
+
+// Dependence tokens, one per tile and ring slot
+static char token[NBUF][TILES_X][TILES_Y];
+
+// Per-tile maximum change, indexed by ring slot
+static double tile_diff[NBUF][NTILES];
+
+// Row pointers of each ring buffer, for the stencil kernel
+static double *rows[NBUF][NX];
+
+// Jacobi update of one tile; returns its maximum change
+static double update_tile(double **u, double **u_new, int ti, int tj) {
+    int i;
+    int i0 = 1 + ti * TILE_X, i1 = i0 + TILE_X;
+    int j0 = 1 + tj * TILE_Y, j1 = j0 + TILE_Y;
+    double diff, max_diff = 0.0;
+
+    if (i1 > NX - 1) i1 = NX - 1;
+    if (j1 > NY - 1) j1 = NY - 1;
+
+    for (i = i0; i < i1; i++) {
+        diff = stencil_5pt_row(u, u_new, NULL, 0, i, j0, j1, 0);
+        if (diff > max_diff) {
+            max_diff = diff;
+        }
+    }
+    return max_diff;
+}
+
+// Spawn the tasks of one iteration
+static void spawn_iteration(int k) {
+    int slot = k % NBUF, next = (k + 1) % NBUF;
+    double **u = rows[slot], **u_new = rows[next];
+
+    for (int ti = 0; ti < TILES_X; ti++) {
+        for (int tj = 0; tj < TILES_Y; tj++) {
+            // Edge tiles depend on themselves in place of missing neighbours
+            int tn = (ti > 0) ? ti - 1 : ti, ts = (ti < TILES_X - 1) ? ti + 1 : ti;
+            int tw = (tj > 0) ? tj - 1 : tj, te = (tj < TILES_Y - 1) ? tj + 1 : tj;
+
+            #pragma omp task firstprivate(ti, tj, slot) \
+                depend(in: token[slot][ti][tj], token[slot][tn][tj], token[slot][ts][tj], \
+                           token[slot][ti][tw], token[slot][ti][te]) \
+                depend(out: token[next][ti][tj])
+            tile_diff[slot][ti * TILES_Y + tj] = update_tile(u, u_new, ti, tj);
+        }
+    }
+}
+
+// Wait for all tiles of iteration k and return its global maximum change.
+// Later iterations keep running while the generating thread waits here.
+static double finish_iteration(int k) {
+    int slot = k % NBUF, next = (k + 1) % NBUF;
+    double max_diff = 0.0;
+
+    for (int ti = 0; ti < TILES_X; ti++) {
+        for (int tj = 0; tj < TILES_Y; tj++) {
+            #pragma omp taskwait depend(in: token[next][ti][tj])
+        }
+    }
+    for (int t = 0; t < NTILES; t++) {
+        if (tile_diff[slot][t] > max_diff) {
+            max_diff = tile_diff[slot][t];
+        }
+    }
+    return max_diff;
+}
+
+int main() {
+    grid_t *buf[NBUF];
+    int i, j, b, iter, converged = -1;
+    double start_time, end_time;
+
+    // Start timing
+    start_time = omp_get_wtime();
+
+    // Initialize every buffer so boundary values survive the rotation
+    for (b = 0; b < NBUF; b++) {
+        buf[b] = (grid_t *)malloc(NX * sizeof(grid_t));
+        for (i = 0; i < NX; i++) {
+            rows[b][i] = buf[b][i];
+            for (j = 0; j < NY; j++) {
+                buf[b][i][j] = 0.0;
+                if (i == 0 || i == NX - 1 || j == 0 || j == NY - 1) {
+                    buf[b][i][j] = 100.0; // Boundary conditions
+                }
+            }
+        }
+    }
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        // Iteration iter may only be spawned once iteration iter - NBUF
+        // has been checked: it overwrites that iteration's result buffer.
+        int checked = 0;
+        for (iter = 0; iter < MAX_ITER; iter++) {
+            while (checked <= iter - NBUF) {
+                if (finish_iteration(checked) < TOLERANCE) {
+                    converged = checked;
+                    break;
+                }
+                checked++;
+            }
+            if (converged >= 0) break;
+            spawn_iteration(iter);
+        }
+
+        // Check the iterations still in flight
+        while (converged < 0 && checked < iter) {
+            if (finish_iteration(checked) < TOLERANCE) {
+                converged = checked;
+            }
+            checked++;
+        }
+        #pragma omp taskwait
+    }
+
+    // Check for convergence
+    if (converged >= 0) {
+        printf("Converged after %d iterations.\n", converged);
+    }
+
+    // End timing
+    end_time = omp_get_wtime();
+    printf("Task dataflow execution time: %f seconds (%d tiles, %d threads)\n",
+           end_time - start_time, NTILES, omp_get_max_threads());
+
+    // Result lives in the buffer written by the last checked iteration
+    grid_t *u = buf[((converged >= 0) ? converged + 1 : MAX_ITER) % NBUF];
+    double avg_temp = 0.0;
+    for (i = 1; i < NX - 1; i++) {
+        for (j = 1; j < NY - 1; j++) {
+            avg_temp += u[i][j];
+        }
+    }
+    avg_temp /= (double)(NX - 2) * (NY - 2);
+    printf("Average interior temperature: %.4f\n", avg_temp);
+
+    for (b = 0; b < NBUF; b++) {
+        free(buf[b]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+#ifndef HEAT_TELEMETRY_H
+#define HEAT_TELEMETRY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// Live solver metrics in a POSIX shared-memory segment (/dev/shm/heat_*).
+//
+// One writer (rank 0) publishes a heat_metrics_t snapshot under a seqlock: the
+// sequence number is odd while the snapshot is being written, so the writer
+// never waits for readers. A reader copies the snapshot and retries if the
+// sequence changed or was odd. heat_top is the reader; the writer can also
+// mirror each snapshot to a Prometheus text file for a local scraper. The
+// writer leaves the segment behind when it ends, holding the final state.
+
+#define HEAT_TELEMETRY_MAGIC 0x48454154u    // "HEAT"
+#define HEAT_TELEMETRY_EVERY 16             // Iterations between snapshots
+#define HEAT_TELEMETRY_PREFIX "/heat_"
+
+enum { HEAT_PHASE_HALO, HEAT_PHASE_SWEEP, HEAT_PHASE_UPDATE, HEAT_PHASE_REDUCE, HEAT_NUM_PHASES };
+enum { HEAT_RUN_RUNNING, HEAT_RUN_CONVERGED, HEAT_RUN_FINISHED };
+
+typedef struct {
+    long iteration;
+    double residual;                        // Global max |u_new - u| of the last iteration
+    double elapsed;                         // Seconds since telemetry was enabled
+    double phase_seconds[HEAT_NUM_PHASES];  // Rank 0, cumulative
+    double updates_per_second;              // Global lattice updates, last interval
+    double imbalance;                       // Max / mean compute time over ranks, last interval
+    int ranks, nx, ny, state;
+} heat_metrics_t;
+
+typedef struct {
+    uint32_t magic;
+    int32_t pid;
+    _Atomic uint64_t seq;
+    heat_metrics_t m;
+} heat_telemetry_t;
+
+static inline const char *heat_phase_name(int phase) {
+    static const char *names[HEAT_NUM_PHASES] = { "halo", "sweep", "update", "reduce" };
+    return names[phase];
+}
+
+static inline const char *heat_run_state_name(int state) {
+    static const char *names[] = { "running", "converged", "finished" };
+    return names[state];
+}
+
+// Segment name for a user-supplied run name: "run1" -> "/heat_run1"
+static inline void heat_telemetry_name(char *out, size_t len, const char *run) {
+    snprintf(out, len, "%s%s", HEAT_TELEMETRY_PREFIX, run[0] == '/' ? run + 1 : run);
+}
+
+// Create (writer) or open (reader) a segment; NULL on failure
+static inline heat_telemetry_t *heat_telemetry_map(const char *shm_name, int create) {
+    int fd = shm_open(shm_name, create ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDONLY, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (create && ftruncate(fd, sizeof(heat_telemetry_t)) != 0) {
+        close(fd);
+        return NULL;
+    }
+    void *p = mmap(NULL, sizeof(heat_telemetry_t), create ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return NULL;
+    }
+    heat_telemetry_t *t = (heat_telemetry_t *)p;
+    if (create) {
+        memset(&t->m, 0, sizeof(t->m));
+        atomic_store_explicit(&t->seq, 0, memory_order_relaxed);
+        t->pid = (int32_t)getpid();
+        t->magic = HEAT_TELEMETRY_MAGIC;
+    } else if (t->magic != HEAT_TELEMETRY_MAGIC) {
+        munmap(p, sizeof(heat_telemetry_t));
+        return NULL;
+    }
+    return t;
+}
+
+static inline void heat_telemetry_unmap(heat_telemetry_t *t) {
+    munmap(t, sizeof(heat_telemetry_t));
+}
+
+// Writer side: never blocks
+static inline void heat_telemetry_publish(heat_telemetry_t *t, const heat_metrics_t *m) {
+    uint64_t seq = atomic_load_explicit(&t->seq, memory_order_relaxed);
+    atomic_store_explicit(&t->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&t->m, m, sizeof(*m));
+    atomic_store_explicit(&t->seq, seq + 2, memory_order_release);
+}
+
+// Reader side: consistent copy of the latest snapshot
+static inline void heat_telemetry_read(const heat_telemetry_t *t, heat_metrics_t *m) {
+    uint64_t before, after;
+    do {
+        before = atomic_load_explicit(&t->seq, memory_order_acquire);
+        memcpy(m, &t->m, sizeof(*m));
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&t->seq, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+// Prometheus text exposition, written to a temporary file and renamed so a
+// scraper never sees a partial file
+static inline void heat_telemetry_prometheus(const char *path, const char *run, const heat_metrics_t *m) {
+    char tmp[4096];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *fp = fopen(tmp, "w");
+    if (fp == NULL) {
+        return;
+    }
+    fprintf(fp, "# HELP heat_iterations_total Jacobi iterations completed\n"
+                "# TYPE heat_iterations_total counter\n"
+                "heat_iterations_total{run=\"%s\"} %ld\n", run, m->iteration);
+    fprintf(fp, "# HELP heat_residual Global max change of the last iteration\n"
+                "# TYPE heat_residual gauge\n"
+                "heat_residual{run=\"%s\"} %.6e\n", run, m->residual);
+    fprintf(fp, "# HELP heat_phase_seconds_total Time per iteration phase on rank 0\n"
+                "# TYPE heat_phase_seconds_total counter\n");
+    for (int p = 0; p < HEAT_NUM_PHASES; p++) {
+        fprintf(fp, "heat_phase_seconds_total{run=\"%s\",phase=\"%s\"} %.6f\n",
+                run, heat_phase_name(p), m->phase_seconds[p]);
+    }
+    fprintf(fp, "# HELP heat_lattice_updates_per_second Grid point updates per second, all ranks\n"
+                "# TYPE heat_lattice_updates_per_second gauge\n"
+                "heat_lattice_updates_per_second{run=\"%s\"} %.6e\n", run, m->updates_per_second);
+    fprintf(fp, "# HELP heat_rank_imbalance Max over mean compute time per rank\n"
+                "# TYPE heat_rank_imbalance gauge\n"
+                "heat_rank_imbalance{run=\"%s\"} %.4f\n", run, m->imbalance);
+    fprintf(fp, "# HELP heat_converged Whether the run has converged\n"
+                "# TYPE heat_converged gauge\n"
+                "heat_converged{run=\"%s\"} %d\n", run, m->state == HEAT_RUN_CONVERGED);
+    if (fclose(fp) == 0) {
+        rename(tmp, path);
+    }
+}
+
+#endif
@@ -0,0 +1,106 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include "heat_telemetry.h"
+
+#define MAX_RUNS 64
+
+// Live view of running solvers.
+//
+//   ./heat_top [-1] [--clean] [run ...]
+//
+// Reads the telemetry segments that libheat publishes when HEAT_TELEMETRY is
+// set (all /dev/shm/heat_* segments if no run is named) and redraws a table
+// every second; -1 prints it once. Reading never blocks the solver.
+// Segments stay after a run ends so its final state shows; --clean removes
+// those of converged, finished and dead runs and exits.
+
+// A running segment whose writer is gone
+static int run_dead(const heat_telemetry_t *t, const heat_metrics_t *m) {
+    return m->state == HEAT_RUN_RUNNING && kill(t->pid, 0) != 0 && errno == ESRCH;
+}
+
+static void print_run(const char *name, const heat_telemetry_t *t) {
+    heat_metrics_t m;
+    double total = 0.0;
+    const char *state;
+
+    heat_telemetry_read(t, &m);
+    state = run_dead(t, &m) ? "dead" : heat_run_state_name(m.state);
+    for (int p = 0; p < HEAT_NUM_PHASES; p++) total += m.phase_seconds[p];
+    printf("%-16s %7d %5d %5dx%-5d %-9s %8ld %10.3e %9.1f %6.2f",
+           name, (int)t->pid, m.ranks, m.nx, m.ny, state, m.iteration, m.residual,
+           m.updates_per_second / 1e6, m.imbalance);
+    for (int p = 0; p < HEAT_NUM_PHASES; p++) {
+        printf(" %6.1f", total > 0.0 ? 100.0 * m.phase_seconds[p] / total : 0.0);
+    }
+    printf(" %9.1f\n", m.elapsed);
+}
+
+int main(int argc, char **argv) {
+    char names[MAX_RUNS][320];
+    int once = 0, clean = 0, fixed = 0, count;
+
+    for (int k = 1; k < argc; k++) {
+        if (strcmp(argv[k], "-1") == 0) {
+            once = 1;
+        } else if (strcmp(argv[k], "--clean") == 0) {
+            clean = 1;
+        } else if (fixed < MAX_RUNS) {
+            heat_telemetry_name(names[fixed++], sizeof(names[0]), argv[k]);
+        }
+    }
+
+    for (;;) {
+        // Runs named on the command line, or every heat_ segment
+        count = fixed;
+        if (fixed == 0) {
+            DIR *dir = opendir("/dev/shm");
+            struct dirent *e;
+            while (dir != NULL && (e = readdir(dir)) != NULL && count < MAX_RUNS) {
+                if (strncmp(e->d_name, HEAT_TELEMETRY_PREFIX + 1, strlen(HEAT_TELEMETRY_PREFIX) - 1) == 0) {
+                    snprintf(names[count++], sizeof(names[0]), "/%s", e->d_name);
+                }
+            }
+            if (dir != NULL) closedir(dir);
+        }
+
+        if (clean) {
+            for (int k = 0; k < count; k++) {
+                heat_telemetry_t *t = heat_telemetry_map(names[k], 0);
+                if (t == NULL) continue;
+                heat_metrics_t m;
+                heat_telemetry_read(t, &m);
+                int done = (m.state != HEAT_RUN_RUNNING || run_dead(t, &m));
+                heat_telemetry_unmap(t);
+                if (done && shm_unlink(names[k]) == 0) {
+                    printf("Removed %s\n", names[k] + strlen(HEAT_TELEMETRY_PREFIX));
+                }
+            }
+            break;
+        }
+
+        if (!once && isatty(STDOUT_FILENO)) {
+            printf("\033[H\033[2J");
+        }
+        printf("%-16s %7s %5s %11s %-9s %8s %10s %9s %6s %6s %6s %6s %6s %9s\n",
+               "RUN", "PID", "RANKS", "GRID", "STATE", "ITER", "RESIDUAL", "MLUP/s", "IMBAL",
+               "HALO%", "SWEEP%", "UPDT%", "RED%", "ELAPSED");
+        for (int k = 0; k < count; k++) {
+            heat_telemetry_t *t = heat_telemetry_map(names[k], 0);
+            if (t == NULL) continue;
+            print_run(names[k] + strlen(HEAT_TELEMETRY_PREFIX), t);
+            heat_telemetry_unmap(t);
+        }
+        fflush(stdout);
+        if (once) break;
+        sleep(1);
+    }
+    return 0;
+}
@@ -0,0 +1,376 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+#include "heat_config.h"
+
+#define NX 500
+#define NY 500
+#define ALPHA 1.0           // Thermal diffusivity
+#define H 1.0               // Grid spacing
+#define T_END 1000.0        // Default simulated time
+#define DT_FTCS 0.2         // Default explicit time step
+#define DT_ADI 5.0          // Default ADI time step
+#define PRINT_EVERY 50      // Steps between progress lines
+#define CHUNK_ROWS 32       // Rows per message in the pipelined Thomas solve
+#define COL_BLOCK 64        // Columns per thread block in the x-direction solve
+#define SIMD_ROWS 8         // Rows per SIMD batch in the y-direction solve
+
+// Time-dependent heat equation u_t = ALPHA * (u_xx + u_yy).
+//
+//   ./heat_transient [ftcs|adi] [dt] [t_end] [config]
+//
+// ftcs: explicit forward-time centred-space, stable for ALPHA*dt/H^2 <= 1/4.
+// adi:  Peaceman-Rachford ADI, unconditionally stable. Each half step solves
+//       tridiagonal systems along one direction with a batched Thomas
+//       algorithm. Lines along i are local to a rank and solved in SIMD across
+//       columns. Lines along j cross rank boundaries and are solved with a
+//       pipelined distributed Thomas algorithm: forward elimination flows
+//       rank 0 -> size-1 and back substitution flows back, in chunks of
+//       CHUNK_ROWS lines so that neighbouring ranks work concurrently. They
+//       are transposed first, so they too are solved in SIMD across rows.
+//
+// Only Dirichlet edges are supported; the optional config file sets their values.
+
+// Forward elimination factors for the constant-coefficient system
+// -r x[k-1] + (1+2r) x[k] - r x[k+1] = d[k], k = 1..n
+static void thomas_factors(int n, double r, double *inv_m, double *cp) {
+    double b = 1.0 + 2.0 * r;
+    inv_m[1] = 1.0 / b;
+    cp[1] = -r * inv_m[1];
+    for (int k = 2; k <= n; k++) {
+        inv_m[k] = 1.0 / (b + r * cp[k - 1]);
+        cp[k] = -r * inv_m[k];
+    }
+}
+
+// Exchange ghost columns with neighbouring ranks
+static void exchange_halo(double **u, int actual_ny, int left, int right,
+                          double *send_buf, double *recv_buf) {
+    int i;
+    for (i = 0; i < NX; i++) send_buf[i] = u[i][1];
+    MPI_Sendrecv(send_buf, NX, MPI_DOUBLE, left, 0,
+                 recv_buf, NX, MPI_DOUBLE, right, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    if (right != MPI_PROC_NULL) {
+        for (i = 0; i < NX; i++) u[i][actual_ny - 1] = recv_buf[i];
+    }
+    for (i = 0; i < NX; i++) send_buf[i] = u[i][actual_ny - 2];
+    MPI_Sendrecv(send_buf, NX, MPI_DOUBLE, right, 1,
+                 recv_buf, NX, MPI_DOUBLE, left, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    if (left != MPI_PROC_NULL) {
+        for (i = 0; i < NX; i++) u[i][0] = recv_buf[i];
+    }
+}
+
+// Explicit FTCS step: u_new = u + re * laplacian(u)
+static void ftcs_step(double **u, double **u_new, int actual_ny, double re) {
+    int i, j;
+    #pragma omp parallel for private(j)
+    for (i = 1; i < NX - 1; i++) {
+        #pragma omp simd
+        for (j = 1; j < actual_ny - 1; j++) {
+            u_new[i][j] = u[i][j] + re * (u[i+1][j] + u[i-1][j]
+                                          + u[i][j+1] + u[i][j-1] - 4.0 * u[i][j]);
+        }
+    }
+}
+
+// First ADI half step: explicit in j, implicit in i (lines are local).
+// Column blocks go to threads; inside a block the recurrence runs along i
+// with a SIMD loop across the block's columns.
+static void adi_sweep_x(double **u, double **w, int actual_ny, double r,
+                        const double *inv_m, const double *cp) {
+    int nblocks = (actual_ny - 2 + COL_BLOCK - 1) / COL_BLOCK;
+
+    #pragma omp parallel for
+    for (int b = 0; b < nblocks; b++) {
+        int j0 = 1 + b * COL_BLOCK;
+        int j1 = (j0 + COL_BLOCK < actual_ny - 1) ? j0 + COL_BLOCK : actual_ny - 1;
+        int i, j;
+
+        // Right-hand side and forward elimination; the Dirichlet rows
+        // i = 0 and i = NX-1 fold into the first and last equations
+        for (i = 1; i < NX - 1; i++) {
+            double lo = (i == 1) ? r : 0.0, hi = (i == NX - 2) ? r : 0.0;
+            double *prev = (i == 1) ? w[0] : w[i - 1];
+            double carry = (i == 1) ? 0.0 : r;
+            #pragma omp simd
+            for (j = j0; j < j1; j++) {
+                double d = u[i][j] + r * (u[i][j-1] - 2.0 * u[i][j] + u[i][j+1])
+                         + lo * w[0][j] + hi * w[NX - 1][j];
+                w[i][j] = (d + carry * prev[j]) * inv_m[i];
+            }
+        }
+        // Back substitution
+        for (i = NX - 3; i >= 1; i--) {
+            #pragma omp simd
+            for (j = j0; j < j1; j++) {
+                w[i][j] -= cp[i] * w[i+1][j];
+            }
+        }
+    }
+}
+
+// Second ADI half step: explicit in i, implicit in j. Lines span all ranks
+// and are solved with the pipelined distributed Thomas algorithm. The lines
+// are transposed into t (t[j * NX + i]) so that, as in adi_sweep_x, the
+// recurrence runs along j with a SIMD loop across a batch of SIMD_ROWS rows;
+// batches go to threads.
+static void adi_sweep_y(double **w, double **u, double *t, int actual_ny, int start_y, double r,
+                        const double *inv_m, const double *cp, int left, int right,
+                        double *line_buf) {
+    int ia, i, j;
+    int first = (left == MPI_PROC_NULL), last = (right == MPI_PROC_NULL);
+    const long jw = actual_ny - 2;      // Last interior column
+    const int nbatch = (NX - 2 + SIMD_ROWS - 1) / SIMD_ROWS;
+
+    // Right-hand side, transposed into t; the Dirichlet ghost columns of u
+    // fold into the first and last equations
+    #pragma omp parallel for private(i, j)
+    for (int b = 0; b < nbatch; b++) {
+        int ba = 1 + b * SIMD_ROWS;
+        int bb = (ba + SIMD_ROWS < NX - 1) ? ba + SIMD_ROWS : NX - 1;
+        for (j = 1; j <= jw; j++) {
+            for (i = ba; i < bb; i++) {
+                double d = w[i][j] + r * (w[i-1][j] - 2.0 * w[i][j] + w[i+1][j]);
+                if (first && j == 1) d += r * u[i][0];
+                if (last && j == jw) d += r * u[i][actual_ny - 1];
+                t[j * NX + i] = d;
+            }
+        }
+    }
+
+    // Forward elimination, chunk by chunk, flowing left to right. Column 0 of
+    // t holds the values coming from the left neighbour.
+    for (ia = 1; ia < NX - 1; ia += CHUNK_ROWS) {
+        int ib = (ia + CHUNK_ROWS < NX - 1) ? ia + CHUNK_ROWS : NX - 1;
+        int n = ib - ia;
+        if (first) {
+            for (i = 0; i < n; i++) line_buf[i] = 0.0;
+        } else {
+            MPI_Recv(line_buf, n, MPI_DOUBLE, left, 2, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+        for (i = ia; i < ib; i++) t[i] = line_buf[i - ia];
+        #pragma omp parallel for private(i, j)
+        for (int ba = ia; ba < ib; ba += SIMD_ROWS) {
+            int bb = (ba + SIMD_ROWS < ib) ? ba + SIMD_ROWS : ib;
+            for (j = 1; j <= jw; j++) {
+                const double m = inv_m[start_y + j - 1];
+                double *cur = t + j * NX, *prev = cur - NX;
+                #pragma omp simd
+                for (i = ba; i < bb; i++) {
+                    cur[i] = (cur[i] + r * prev[i]) * m;
+                }
+            }
+        }
+        for (i = ia; i < ib; i++) line_buf[i - ia] = t[jw * NX + i];
+        if (!last) {
+            MPI_Send(line_buf, n, MPI_DOUBLE, right, 2, MPI_COMM_WORLD);
+        }
+    }
+
+    // Back substitution, chunk by chunk, flowing right to left. Column
+    // jw + 1 of t holds the values coming from the right neighbour.
+    for (ia = 1; ia < NX - 1; ia += CHUNK_ROWS) {
+        int ib = (ia + CHUNK_ROWS < NX - 1) ? ia + CHUNK_ROWS : NX - 1;
+        int n = ib - ia;
+        if (last) {
+            for (i = 0; i < n; i++) line_buf[i] = 0.0;
+        } else {
+            MPI_Recv(line_buf, n, MPI_DOUBLE, right, 3, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+        for (i = ia; i < ib; i++) t[(jw + 1) * NX + i] = line_buf[i - ia];
+        #pragma omp parallel for private(i, j)
+        for (int ba = ia; ba < ib; ba += SIMD_ROWS) {
+            int bb = (ba + SIMD_ROWS < ib) ? ba + SIMD_ROWS : ib;
+            for (j = jw; j >= 1; j--) {
+                const double c = cp[start_y + j - 1];
+                double *cur = t + j * NX, *next = cur + NX;
+                #pragma omp simd
+                for (i = ba; i < bb; i++) {
+                    cur[i] -= c * next[i];
+                }
+            }
+        }
+        for (i = ia; i < ib; i++) line_buf[i - ia] = t[NX + i];
+        if (!first) {
+            MPI_Send(line_buf, n, MPI_DOUBLE, left, 3, MPI_COMM_WORLD);
+        }
+    }
+
+    // Solution back into u
+    #pragma omp parallel for private(i, j)
+    for (int b = 0; b < nbatch; b++) {
+        int ba = 1 + b * SIMD_ROWS;
+        int bb = (ba + SIMD_ROWS < NX - 1) ? ba + SIMD_ROWS : NX - 1;
+        for (j = 1; j <= jw; j++) {
+            for (i = ba; i < bb; i++) {
+                u[i][j] = t[j * NX + i];
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    double **u, **w, **tmp;
+    double *send_buf, *recv_buf, *line_buf, *tw;
+    double *inv_mx, *cpx, *inv_my, *cpy;
+    int i, j, step, nsteps;
+    int rank, size;
+    int local_ny, start_y, end_y;
+    double start_time, end_time;
+    heat_config_t cfg;
+
+    // Initialize MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Command line: method, time step, end time, boundary config
+    int use_adi = (argc > 1 && strcmp(argv[1], "adi") == 0);
+    if (argc > 1 && !use_adi && strcmp(argv[1], "ftcs") != 0) {
+        if (rank == 0) {
+            fprintf(stderr, "Usage: %s [ftcs|adi] [dt] [t_end] [config]\n", argv[0]);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    double dt = (argc > 2) ? atof(argv[2]) : (use_adi ? DT_ADI : DT_FTCS);
+    double t_end = (argc > 3) ? atof(argv[3]) : T_END;
+
+    heat_config_default(&cfg);
+    if (argc > 4 && heat_config_load(argv[4], &cfg) != 0) {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int e = 0; e < NUM_EDGES; e++) {
+        if (cfg.type[e] != BC_DIRICHLET) {
+            if (rank == 0) {
+                fprintf(stderr, "Error: transient solver supports Dirichlet edges only\n");
+            }
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    if (cfg.conductivity_file[0] != '\0' || cfg.source_file[0] != '\0') {
+        if (rank == 0) {
+            fprintf(stderr, "Error: transient solver needs uniform conductivity and no source\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    // Explicit stability limit: ALPHA * dt / H^2 <= 1/4
+    double re = ALPHA * dt / (H * H);
+    double dt_limit = 0.25 * H * H / ALPHA;
+    if (dt <= 0.0 || (!use_adi && dt > dt_limit)) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: FTCS is unstable for dt = %g (limit %g); use a smaller dt or adi\n",
+                    dt, dt_limit);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    nsteps = (int)ceil(t_end / dt - 1e-9);
+
+    // Divide the domain among processes (row-wise decomposition)
+    local_ny = (NY - 2) / size;
+    start_y = rank * local_ny + 1;
+    end_y = (rank == size - 1) ? (NY - 1) : (start_y + local_ny);
+    int actual_ny = end_y - start_y + 2;
+    int left = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
+    int right = (rank < size - 1) ? rank + 1 : MPI_PROC_NULL;
+
+    u = (double **)malloc(NX * sizeof(double *));
+    w = (double **)malloc(NX * sizeof(double *));
+    for (i = 0; i < NX; i++) {
+        u[i] = (double *)malloc(actual_ny * sizeof(double));
+        w[i] = (double *)malloc(actual_ny * sizeof(double));
+    }
+    send_buf = (double *)malloc(NX * sizeof(double));
+    recv_buf = (double *)malloc(NX * sizeof(double));
+    line_buf = (double *)malloc(CHUNK_ROWS * sizeof(double));
+    tw = (double *)malloc((size_t)NX * actual_ny * sizeof(double));     // Transposed lines
+
+    // Thomas factors; half-step coefficient r = ALPHA * dt / (2 H^2)
+    double r = 0.5 * re;
+    inv_mx = (double *)malloc(NX * sizeof(double));
+    cpx = (double *)malloc(NX * sizeof(double));
+    inv_my = (double *)malloc(NY * sizeof(double));
+    cpy = (double *)malloc(NY * sizeof(double));
+    thomas_factors(NX - 2, r, inv_mx, cpx);
+    thomas_factors(NY - 2, r, inv_my, cpy);
+
+    // Initial condition: zero interior, Dirichlet edges in both buffers
+    for (i = 0; i < NX; i++) {
+        for (j = 0; j < actual_ny; j++) {
+            u[i][j] = heat_initial_value(&cfg, i, start_y + j - 1, NX, NY);
+            w[i][j] = u[i][j];
+        }
+    }
+
+    if (rank == 0) {
+        printf("=== 2D Heat Equation - Transient %s ===\n", use_adi ? "ADI (Peaceman-Rachford)" : "FTCS");
+        printf("Grid size: %d x %d, alpha = %g, dt = %g, t_end = %g, steps = %d\n",
+               NX, NY, ALPHA, dt, t_end, nsteps);
+        if (use_adi && dt > dt_limit) {
+            printf("Time step is %.1fx the explicit stability limit\n", dt / dt_limit);
+        }
+    }
+
+    // Start timing
+    start_time = MPI_Wtime();
+
+    for (step = 1; step <= nsteps; step++) {
+        exchange_halo(u, actual_ny, left, right, send_buf, recv_buf);
+        if (use_adi) {
+            adi_sweep_x(u, w, actual_ny, r, inv_mx, cpx);
+            adi_sweep_y(w, u, tw, actual_ny, start_y, r, inv_my, cpy, left, right, line_buf);
+        } else {
+            ftcs_step(u, w, actual_ny, re);
+            tmp = u;
+            u = w;
+            w = tmp;
+        }
+
+        if (step % PRINT_EVERY == 0 || step == nsteps) {
+            double local_sum = 0.0, sum;
+            for (i = 1; i < NX - 1; i++) {
+                for (j = 1; j < actual_ny - 1; j++) {
+                    local_sum += u[i][j];
+                }
+            }
+            MPI_Reduce(&local_sum, &sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+            if (rank == 0) {
+                printf("t = %10.3f  mean interior temperature = %.6f\n",
+                       step * dt, sum / ((double)(NX - 2) * (NY - 2)));
+            }
+        }
+    }
+
+    // End timing
+    end_time = MPI_Wtime();
+    if (rank == 0) {
+        printf("Transient execution time: %f seconds (%d steps)\n", end_time - start_time, nsteps);
+    }
+
+    // Free memory
+    for (i = 0; i < NX; i++) {
+        free(u[i]);
+        free(w[i]);
+    }
+    free(u);
+    free(w);
+    free(send_buf);
+    free(recv_buf);
+    free(line_buf);
+    free(tw);
+    free(inv_mx);
+    free(cpx);
+    free(inv_my);
+    free(cpy);
+
+    MPI_Finalize();
+    return 0;
+}
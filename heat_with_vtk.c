@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <math.h>
 
+#include "heat_stencil.h"
+
 #define NX 500
 #define NY 500
 #define MAX_ITER 1000
@@ -39,11 +41,14 @@ void write_vtk_file(const char *filename, double u[NX][NY]) {
 
 int main() {
     double u[NX][NY], u_new[NX][NY];
+    double *rows[NX], *rows_new[NX];
     int i, j, iter;
-    double diff, max_diff;
+    double max_diff;
 
     // Initialize the grid
     for (i = 0; i < NX; i++) {
+        rows[i] = u[i];
+        rows_new[i] = u_new[i];
         for (j = 0; j < NY; j++) {
             u[i][j] = 0.0;
             if (i == 0 || i == NX - 1 || j == 0 || j == NY - 1) {
@@ -54,18 +59,7 @@ int main() {
 
     // Iterative solver
     for (iter = 0; iter < MAX_ITER; iter++) {
-        max_diff = 0.0;
-
-        for (i = 1; i < NX - 1; i++) {
-            for (j = 1; j < NY - 1; j++) {
-                u_new[i][j] = 0.25 * (u[i+1][j] + u[i-1][j]
-                                     + u[i][j+1] + u[i][j-1]);
-                diff = fabs(u_new[i][j] - u[i][j]);
-                if (diff > max_diff) {
-                    max_diff = diff;
-                }
-            }
-        }
+        max_diff = stencil_5pt.sweep(rows, rows_new, 1, NX - 1, 1, NY - 1);
 
         // Update u
         for (i = 1; i < NX - 1; i++) {
@@ -0,0 +1,318 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "libheat.h"
+
+// CPython extension `heat`: runs the libheat solver in-process and exposes the
+// live grid through the buffer protocol, so no file round-trip and no copy.
+//
+//     import heat
+//     s = heat.Solver(500, 500)                  # optional config="bc.cfg"
+//     s.solve(1000, 1e-6, callback=lambda it, r: print(it, r), every=100)
+//     m = memoryview(s)                          # 2D float64 view, m[i, j]
+//     u = numpy.asarray(s)                       # same memory, if NumPy is around
+//
+// Building needs only the Python headers. The view is writable and stays valid
+// while any exporter holds it: each export keeps the solver alive, and
+// re-running __init__ raises BufferError while views are exported. Steps
+// run with the GIL released; the callback takes it back every `every`
+// iterations and stops the run by returning False.
+
+typedef struct {
+    PyObject_HEAD
+    heat_solver_t *solver;
+    Py_buffer source;           // Caller's source field, held while the solver lives
+    Py_ssize_t shape[2], strides[2];
+    int busy;                   // A step/solve is running with the GIL released
+    Py_ssize_t exports;         // Live buffer views of the grid
+    PyObject *callback;         // Progress callback of the running call
+    PyObject *exc_type, *exc_value, *exc_tb;    // Raised by the callback
+} SolverObject;
+
+static void solver_clear(SolverObject *self) {
+    heat_destroy(self->solver);
+    self->solver = NULL;
+    if (self->source.obj != NULL) {
+        PyBuffer_Release(&self->source);
+    }
+}
+
+static void Solver_dealloc(SolverObject *self) {
+    solver_clear(self);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int Solver_init(SolverObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = { "nx", "ny", "config", "source", NULL };
+    int nx = 500, ny = 500;
+    const char *config = NULL;
+    PyObject *source = Py_None;
+    heat_options_t opts;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|iizO", kwlist, &nx, &ny, &config, &source)) {
+        return -1;
+    }
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "solver is running");
+        return -1;
+    }
+    // Views point into the grid and at shape/strides; keep them valid
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot re-initialize a solver with exported views");
+        return -1;
+    }
+    solver_clear(self);
+    heat_options_default(&opts, nx, ny);
+    if (config != NULL && heat_config_load(config, &opts.config) != 0) {
+        PyErr_Format(PyExc_ValueError, "cannot load config file %s", config);
+        return -1;
+    }
+
+    // Source field: any C-contiguous float64 buffer of nx * ny values, not copied
+    if (source != Py_None) {
+        if (PyObject_GetBuffer(source, &self->source, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+            return -1;
+        }
+        if (strcmp(self->source.format ? self->source.format : "B", "d") != 0 ||
+            self->source.len != (Py_ssize_t)nx * ny * (Py_ssize_t)sizeof(double)) {
+            PyBuffer_Release(&self->source);
+            PyErr_Format(PyExc_ValueError, "source must be %d x %d float64 values", nx, ny);
+            return -1;
+        }
+        opts.source = (const double *)self->source.buf;
+    }
+
+    self->solver = heat_create(&opts);
+    if (self->solver == NULL) {
+        solver_clear(self);
+        PyErr_SetString(PyExc_ValueError, "cannot create solver");
+        return -1;
+    }
+    heat_field_t f = heat_field(self->solver);
+    self->shape[0] = f.nx;
+    self->shape[1] = f.ny;
+    self->strides[0] = f.stride * (Py_ssize_t)sizeof(double);
+    self->strides[1] = sizeof(double);
+    return 0;
+}
+
+static int check_ready(SolverObject *self) {
+    if (self->solver == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "solver is not initialized");
+        return -1;
+    }
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "solver is running");
+        return -1;
+    }
+    return 0;
+}
+
+// Progress hook, called from libheat without the GIL
+static int progress_trampoline(void *user, int iteration, double residual) {
+    SolverObject *self = (SolverObject *)user;
+    PyGILState_STATE gil = PyGILState_Ensure();
+    PyObject *ret = PyObject_CallFunction(self->callback, "id", iteration, residual);
+    int stop;
+    if (ret == NULL) {
+        PyErr_Fetch(&self->exc_type, &self->exc_value, &self->exc_tb);
+        stop = 1;
+    } else {
+        stop = (ret == Py_False);
+        Py_DECREF(ret);
+    }
+    PyGILState_Release(gil);
+    return stop;
+}
+
+static int begin_run(SolverObject *self, PyObject *callback, int every) {
+    if (check_ready(self) != 0) return -1;
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "callback must be callable");
+        return -1;
+    }
+    self->busy = 1;
+    if (callback != Py_None) {
+        Py_INCREF(callback);
+        self->callback = callback;
+        heat_set_progress(self->solver, every, progress_trampoline, self);
+    }
+    return 0;
+}
+
+// Returns -1 with the callback's exception set if it raised
+static int end_run(SolverObject *self) {
+    heat_set_progress(self->solver, 0, NULL, NULL);
+    Py_CLEAR(self->callback);
+    self->busy = 0;
+    if (self->exc_type != NULL) {
+        PyErr_Restore(self->exc_type, self->exc_value, self->exc_tb);
+        self->exc_type = self->exc_value = self->exc_tb = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *Solver_step(SolverObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = { "n", "callback", "every", NULL };
+    int n = 1, every = 100;
+    PyObject *callback = Py_None;
+    double residual;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|iOi", kwlist, &n, &callback, &every)) {
+        return NULL;
+    }
+    if (begin_run(self, callback, every) != 0) return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    residual = heat_step(self->solver, n);
+    Py_END_ALLOW_THREADS
+    if (end_run(self) != 0) return NULL;
+    return PyFloat_FromDouble(residual);
+}
+
+static PyObject *Solver_solve(SolverObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = { "max_iter", "tol", "callback", "every", NULL };
+    int max_iter = 1000, every = 100, iter;
+    double tol = 1e-6;
+    PyObject *callback = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|idOi", kwlist, &max_iter, &tol, &callback, &every)) {
+        return NULL;
+    }
+    if (begin_run(self, callback, every) != 0) return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    iter = heat_solve(self->solver, max_iter, tol);
+    Py_END_ALLOW_THREADS
+    if (end_run(self) != 0) return NULL;
+    if (iter < 0) Py_RETURN_NONE;
+    return PyLong_FromLong(iter);
+}
+
+static PyObject *Solver_residuals(SolverObject *self, PyObject *Py_UNUSED(ignored)) {
+    int count;
+    if (check_ready(self) != 0) return NULL;
+    const double *res = heat_residuals(self->solver, &count);
+    PyObject *list = PyList_New(count);
+    if (list == NULL) return NULL;
+    for (int k = 0; k < count; k++) {
+        PyObject *v = PyFloat_FromDouble(res[k]);
+        if (v == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, k, v);
+    }
+    return list;
+}
+
+static PyObject *Solver_average(SolverObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (check_ready(self) != 0) return NULL;
+    return PyFloat_FromDouble(heat_interior_average(self->solver));
+}
+
+static PyObject *Solver_get_shape(SolverObject *self, void *Py_UNUSED(closure)) {
+    if (check_ready(self) != 0) return NULL;
+    return Py_BuildValue("(nn)", self->shape[0], self->shape[1]);
+}
+
+static PyObject *Solver_get_iterations(SolverObject *self, void *Py_UNUSED(closure)) {
+    int count;
+    if (check_ready(self) != 0) return NULL;
+    heat_residuals(self->solver, &count);
+    return PyLong_FromLong(count);
+}
+
+// Buffer export: the solver's current grid, rows padded to the arena alignment
+static int Solver_getbuffer(SolverObject *self, Py_buffer *view, int flags) {
+    if (self->solver == NULL) {
+        PyErr_SetString(PyExc_BufferError, "solver is not initialized");
+        return -1;
+    }
+    if ((flags & PyBUF_STRIDES) != PyBUF_STRIDES) {
+        PyErr_SetString(PyExc_BufferError, "grid rows are padded; request a strided buffer");
+        return -1;
+    }
+    if ((flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS ||
+        (flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS ||
+        (flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS) {
+        if (self->strides[0] != self->shape[1] * (Py_ssize_t)sizeof(double)) {
+            PyErr_SetString(PyExc_BufferError, "grid rows are padded, not contiguous");
+            return -1;
+        }
+    }
+    view->buf = heat_field(self->solver).data;
+    view->obj = (PyObject *)self;
+    Py_INCREF(self);
+    view->len = self->shape[0] * self->shape[1] * (Py_ssize_t)sizeof(double);
+    view->readonly = 0;
+    view->itemsize = sizeof(double);
+    view->format = (flags & PyBUF_FORMAT) ? "d" : NULL;
+    view->ndim = 2;
+    view->shape = self->shape;
+    view->strides = self->strides;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    self->exports++;
+    return 0;
+}
+
+static void Solver_releasebuffer(SolverObject *self, Py_buffer *Py_UNUSED(view)) {
+    self->exports--;
+}
+
+static PyBufferProcs Solver_as_buffer = {
+    .bf_getbuffer = (getbufferproc)Solver_getbuffer,
+    .bf_releasebuffer = (releasebufferproc)Solver_releasebuffer,
+};
+
+static PyMethodDef Solver_methods[] = {
+    { "step", (PyCFunction)(void (*)(void))Solver_step, METH_VARARGS | METH_KEYWORDS,
+      "step(n=1, callback=None, every=100) -> residual of the last iteration" },
+    { "solve", (PyCFunction)(void (*)(void))Solver_solve, METH_VARARGS | METH_KEYWORDS,
+      "solve(max_iter=1000, tol=1e-6, callback=None, every=100) -> converged iteration or None" },
+    { "residuals", (PyCFunction)Solver_residuals, METH_NOARGS,
+      "residuals() -> list with the residual of every iteration" },
+    { "average", (PyCFunction)Solver_average, METH_NOARGS,
+      "average() -> average interior temperature" },
+    { NULL }
+};
+
+static PyGetSetDef Solver_getset[] = {
+    { "shape", (getter)Solver_get_shape, NULL, "(nx, ny) of the grid", NULL },
+    { "iterations", (getter)Solver_get_iterations, NULL, "iterations since creation", NULL },
+    { NULL }
+};
+
+static PyTypeObject SolverType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "heat.Solver",
+    .tp_doc = "Solver(nx=500, ny=500, config=None, source=None): in-process heat equation solver.\n"
+              "The object exports its live grid through the buffer protocol.",
+    .tp_basicsize = sizeof(SolverObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)Solver_init,
+    .tp_dealloc = (destructor)Solver_dealloc,
+    .tp_as_buffer = &Solver_as_buffer,
+    .tp_methods = Solver_methods,
+    .tp_getset = Solver_getset,
+};
+
+static struct PyModuleDef heat_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "heat",
+    .m_doc = "In-process 2D heat equation solver with a zero-copy grid view.",
+    .m_size = -1,
+};
+
+PyMODINIT_FUNC PyInit_heat(void) {
+    if (PyType_Ready(&SolverType) < 0) return NULL;
+    PyObject *m = PyModule_Create(&heat_module);
+    if (m == NULL) return NULL;
+    Py_INCREF(&SolverType);
+    if (PyModule_AddObject(m, "Solver", (PyObject *)&SolverType) < 0) {
+        Py_DECREF(&SolverType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    return m;
+}
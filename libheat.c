@@ -0,0 +1,1039 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "libheat.h"
+#include "heat_arena.h"
+#include "heat_telemetry.h"
+#include "heat_render.h"
+
+// Packed analytics partials: residual, max and -min combine by max, then sum,
+// sum of squared changes, edge fluxes, histogram and crossings combine by sum
+enum { ANALYTICS_NMAX = 3, ANALYTICS_FIXED = 5 + NUM_EDGES };
+
+// Solver state behind the libheat API. The serial context is the one-rank
+// case of the column decomposition: one block with no neighbours.
+
+struct heat_solver {
+    int nx, ny;                 // Global grid
+    int local_ny;               // Local columns, including the two ghost/edge columns
+    int start_y;                // Global column of local column 1
+    int has_west, has_east;     // First/last local column is a global edge
+    int rank, size;             // Position in the decomposition
+    heat_config_t cfg;
+    double *own_source;         // Loaded from cfg.source_file, freed on destroy
+    const double *local_source; // Source values of local column 0
+    heat_sweep_fn sweep;
+    // Variable conductivity: harmonic-mean coefficients of the faces to row
+    // i - 1 and column j - 1, and the reciprocal of their sum over the four
+    // faces of a point; local block, stride local_ny, double or float
+    void *coef_n, *coef_w, *coef_d;
+    double (*coef_row)(const struct heat_solver *s, int i);    // NULL if uniform
+    heat_arena_t arena;
+    double **u, **u_new;
+    double *send_buf, *recv_buf;
+    double *residuals;
+    int num_residuals, max_residuals;
+    heat_progress_fn progress;
+    void *progress_user;
+    int progress_every;
+    // Telemetry: every rank times its phases, rank 0 owns the segment
+    int telemetry_on;
+    heat_telemetry_t *telemetry;
+    char telemetry_name[128], run_name[64], prometheus_path[4096];
+    heat_metrics_t metrics;
+    double telemetry_start, interval_start, interval_compute, last_prometheus;
+    int interval_iter;
+    // In-situ rendering: frames every render_every iterations (0 = off)
+    int render_every, render_downsample, render_last;
+    char render_pattern[4096];
+    heat_colormap_t colormap;
+    double render_lo, render_hi;
+    // Fused analytics on every analytics_every-th iteration (0 = off)
+    int analytics_every, have_analytics;
+    heat_analytics_t analytics;
+    double analytics_buf[ANALYTICS_FIXED + HEAT_ANALYTICS_MAX_BINS + HEAT_ANALYTICS_MAX_LEVELS];
+    FILE *analytics_out;        // Rank 0 time series
+#ifdef HEAT_WITH_MPI
+    MPI_Comm comm;              // MPI_COMM_NULL in the serial context
+    int left, right;
+    MPI_Op analytics_op;        // MPI_OP_NULL until analytics are enabled
+#endif
+};
+
+static double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+void heat_options_default(heat_options_t *opts, int nx, int ny) {
+    opts->nx = nx;
+    opts->ny = ny;
+    heat_config_default(&opts->config);
+    opts->source = NULL;
+    opts->conductivity = NULL;
+}
+
+// Initial field from the boundary conditions; clears the residual history
+static void init_field(heat_solver_t *s) {
+    double **u = s->u;
+    int i, j;
+
+#ifdef _OPENMP
+    #pragma omp parallel for private(i, j) collapse(2)
+#endif
+    for (i = 0; i < s->nx; i++) {
+        for (j = 0; j < s->local_ny; j++) {
+            int global_j = s->start_y + j - 1;
+            u[i][j] = heat_initial_value(&s->cfg, i, global_j, s->nx, s->ny);
+        }
+    }
+    heat_apply_bc(&s->cfg, s->u, s->nx, s->local_ny, s->has_west, s->has_east);
+    s->num_residuals = 0;
+}
+
+#ifdef HEAT_WITH_MPI
+// Neighbours in the decomposition; periodic west/east edges close the ring
+static void set_neighbours(heat_solver_t *s) {
+    int periodic = (s->cfg.type[EDGE_WEST] == BC_PERIODIC && s->size > 1);
+    s->left = (s->rank > 0) ? s->rank - 1 : (periodic ? s->size - 1 : MPI_PROC_NULL);
+    s->right = (s->rank < s->size - 1) ? s->rank + 1 : (periodic ? 0 : MPI_PROC_NULL);
+}
+#endif
+
+// Default colour scale: the initial zero and every Dirichlet value
+static void render_range(const heat_config_t *cfg, double *lo, double *hi) {
+    *lo = *hi = 0.0;
+    for (int e = 0; e < NUM_EDGES; e++) {
+        if (cfg->type[e] != BC_DIRICHLET) continue;
+        if (cfg->value[e] < *lo) *lo = cfg->value[e];
+        if (cfg->value[e] > *hi) *hi = cfg->value[e];
+    }
+    if (*hi <= *lo) *hi = *lo + 1.0;
+}
+
+// Settings heat_render uses until heat_enable_render changes them
+static void render_defaults(heat_solver_t *s) {
+    heat_colormap("hot", &s->colormap);
+    s->render_every = 0;
+    s->render_downsample = 1;
+    s->render_last = -1;
+    render_range(&s->cfg, &s->render_lo, &s->render_hi);
+}
+
+// Harmonic mean of the conductivities on either side of a face
+static double face_coefficient(double a, double b) {
+    return 2.0 * a * b / (a + b);
+}
+
+static void coef_store(void *a, int is_float, long k, double v) {
+    if (is_float) {
+        ((float *)a)[k] = (float)v;
+    } else {
+        ((double *)a)[k] = v;
+    }
+}
+
+static double coef_load(const void *a, int is_float, long k) {
+    return is_float ? ((const float *)a)[k] : ((const double *)a)[k];
+}
+
+// Conductivity at global point (i, j). Periodic edge lines are copies of the
+// opposite interior lines (see heat_apply_bc), so they take that line's
+// conductivity and the seam faces couple k[n-2] with k[1].
+static double conductivity_at(const heat_solver_t *s, const double *k, int i, int j) {
+    if (s->cfg.type[EDGE_NORTH] == BC_PERIODIC) {
+        if (i == 0) i = s->nx - 2;
+        else if (i == s->nx - 1) i = 1;
+    }
+    if (s->cfg.type[EDGE_WEST] == BC_PERIODIC) {
+        if (j == 0) j = s->ny - 2;
+        else if (j == s->ny - 1) j = 1;
+    }
+    return k[(long)i * s->ny + j];
+}
+
+// Face coefficients and reciprocal diagonals of the local block from the
+// global conductivity map k. The reciprocals are taken of the stored (possibly
+// rounded) faces, so uniform conductivity gives exactly 0.25.
+static void build_coefficients(heat_solver_t *s, const double *k) {
+    const int j0 = s->start_y - 1;              // Global column of local column 0
+    const long stride = s->local_ny;
+    const int fl = s->cfg.conductivity_float;
+    int i, j;
+
+    for (i = 0; i < s->nx; i++) {
+        for (j = 0; j < s->local_ny; j++) {
+            double kc = conductivity_at(s, k, i, j0 + j);
+            coef_store(s->coef_n, fl, i * stride + j,
+                       (i > 0) ? face_coefficient(conductivity_at(s, k, i - 1, j0 + j), kc) : 0.0);
+            coef_store(s->coef_w, fl, i * stride + j,
+                       (j > 0) ? face_coefficient(conductivity_at(s, k, i, j0 + j - 1), kc) : 0.0);
+            coef_store(s->coef_d, fl, i * stride + j, 0.0);
+        }
+    }
+    for (i = 1; i < s->nx - 1; i++) {
+        for (j = 1; j < s->local_ny - 1; j++) {
+            long p = i * stride + j;
+            double sum = coef_load(s->coef_n, fl, p) + coef_load(s->coef_n, fl, p + stride) +
+                         coef_load(s->coef_w, fl, p) + coef_load(s->coef_w, fl, p + 1);
+            coef_store(s->coef_d, fl, p, 1.0 / sum);
+        }
+    }
+}
+
+// Variable-conductivity Jacobi update of interior row i:
+//     u_new = (ks u_down + kn u_up + ke u_right + kw u_left + f) * d
+// (the order of the constant kernel, which it reproduces bit for bit at k = 1)
+// with d = 1 / (kn + ks + kw + ke) precomputed, so the loop is multiply-adds
+// only. ks and ke are the north and west faces of the next row and column,
+// which leaves three coefficient arrays to stream. One instantiation per
+// coefficient type, with and without a source.
+#ifdef _OPENMP
+#define COEF_SIMD _Pragma("omp simd reduction(max:max_diff)")
+#else
+#define COEF_SIMD
+#endif
+
+#define DEFINE_COEF_ROW(NAME, T, HAS_SOURCE)                                        \
+    static double NAME(const heat_solver_t *s, int i) {                            \
+        const long stride = s->local_ny;                                           \
+        const double *up = s->u[i - 1], *row = s->u[i], *down = s->u[i + 1];       \
+        const T *kn = (const T *)s->coef_n + i * stride, *ks = kn + stride;        \
+        const T *kw = (const T *)s->coef_w + i * stride;                           \
+        const T *kd = (const T *)s->coef_d + i * stride;                           \
+        const double *f = HAS_SOURCE ? s->local_source + (long)i * s->ny : NULL;   \
+        double *out = s->u_new[i];                                                 \
+        double diff, max_diff = 0.0;                                               \
+        COEF_SIMD                                                                  \
+        for (int j = 1; j < s->local_ny - 1; j++) {                                \
+            double acc = ks[j] * down[j] + kn[j] * up[j] +                         \
+                         kw[j + 1] * row[j + 1] + kw[j] * row[j - 1];              \
+            if (HAS_SOURCE) acc += f[j];                                           \
+            out[j] = kd[j] * acc;                                                  \
+            diff = fabs(out[j] - row[j]);                                          \
+            max_diff = (diff > max_diff) ? diff : max_diff;                        \
+        }                                                                          \
+        return max_diff;                                                           \
+    }
+
+DEFINE_COEF_ROW(coef_row_double, double, 0)
+DEFINE_COEF_ROW(coef_row_double_source, double, 1)
+DEFINE_COEF_ROW(coef_row_float, float, 0)
+DEFINE_COEF_ROW(coef_row_float_source, float, 1)
+
+// Variable-conductivity sweep of the interior, rows shared among threads
+static double coef_sweep(heat_solver_t *s) {
+    double diff, max_diff = 0.0;
+    int i;
+
+#ifdef _OPENMP
+    #pragma omp parallel for private(diff) reduction(max:max_diff)
+#endif
+    for (i = 1; i < s->nx - 1; i++) {
+        diff = s->coef_row(s, i);
+        if (diff > max_diff) {
+            max_diff = diff;
+        }
+    }
+    return max_diff;
+}
+
+// Shared part of heat_create and heat_create_mpi
+static heat_solver_t *solver_init(const heat_options_t *opts, int rank, int size) {
+    heat_solver_t *s;
+
+    if (opts->nx < 3 || opts->ny - 2 < size) {
+        fprintf(stderr, "Error: grid %d x %d is too small for %d ranks\n", opts->nx, opts->ny, size);
+        return NULL;
+    }
+    s = (heat_solver_t *)calloc(1, sizeof(*s));
+    s->nx = opts->nx;
+    s->ny = opts->ny;
+    s->cfg = opts->config;
+    s->rank = rank;
+    s->size = size;
+#ifdef HEAT_WITH_MPI
+    s->comm = MPI_COMM_NULL;
+    s->left = s->right = MPI_PROC_NULL;
+    s->analytics_op = MPI_OP_NULL;
+#endif
+
+    // Source term: caller's field, or the file named in the config
+    const double *source = opts->source;
+    if (source == NULL && s->cfg.source_file[0] != '\0') {
+        s->own_source = heat_source_load(s->cfg.source_file, s->nx, s->ny);
+        if (s->own_source == NULL) {
+            free(s);
+            return NULL;
+        }
+        source = s->own_source;
+    }
+    s->sweep = heat_select_sweep(source);
+
+    // Divide the domain among processes (column-wise decomposition)
+    int local_ny = (s->ny - 2) / size;
+    s->start_y = rank * local_ny + 1;
+    int end_y = (rank == size - 1) ? (s->ny - 1) : (s->start_y + local_ny);
+    s->local_ny = end_y - s->start_y + 2;
+    s->has_west = (rank == 0);
+    s->has_east = (rank == size - 1);
+
+    // Source values of this rank's columns (global column start_y - 1 is local 0)
+    s->local_source = (source != NULL) ? source + (s->start_y - 1) : NULL;
+
+    // Conductivity map: caller's field, or the file named in the config; only
+    // the face coefficients of this rank's block are kept
+    const double *conductivity = opts->conductivity;
+    double *own_conductivity = NULL;
+    if (conductivity == NULL && s->cfg.conductivity_file[0] != '\0') {
+        own_conductivity = heat_field_load(s->cfg.conductivity_file, "conductivity", s->nx, s->ny);
+        if (own_conductivity == NULL) {
+            free(s->own_source);
+            free(s);
+            return NULL;
+        }
+        conductivity = own_conductivity;
+    }
+    for (long k = 0; conductivity != NULL && k < (long)s->nx * s->ny; k++) {
+        if (!(conductivity[k] > 0.0) || !isfinite(conductivity[k])) {
+            fprintf(stderr, "Error: conductivity must be positive (point %ld, %ld is %g)\n",
+                    k / s->ny, k % s->ny, conductivity[k]);
+            free(own_conductivity);
+            free(s->own_source);
+            free(s);
+            return NULL;
+        }
+    }
+    size_t coef_bytes = 0;
+    if (conductivity != NULL) {
+        coef_bytes = (size_t)s->nx * s->local_ny *
+                     (s->cfg.conductivity_float ? sizeof(float) : sizeof(double));
+    }
+
+    // Grids, halo buffers and coefficients from one huge-page arena
+    if (heat_arena_init(&s->arena, 2 * heat_arena_grid_bytes(s->nx, s->local_ny) +
+                                   2 * (s->nx * sizeof(double) + HEAT_ARENA_ALIGN) +
+                                   (coef_bytes > 0 ? 3 * (coef_bytes + HEAT_ARENA_ALIGN) : 0)) != 0) {
+        free(own_conductivity);
+        free(s->own_source);
+        free(s);
+        return NULL;
+    }
+    s->u = heat_arena_grid(&s->arena, s->nx, s->local_ny);
+    s->u_new = heat_arena_grid(&s->arena, s->nx, s->local_ny);
+    s->send_buf = (double *)heat_arena_alloc(&s->arena, s->nx * sizeof(double));
+    s->recv_buf = (double *)heat_arena_alloc(&s->arena, s->nx * sizeof(double));
+    if (conductivity != NULL) {
+        s->coef_n = heat_arena_alloc(&s->arena, coef_bytes);
+        s->coef_w = heat_arena_alloc(&s->arena, coef_bytes);
+        s->coef_d = heat_arena_alloc(&s->arena, coef_bytes);
+        build_coefficients(s, conductivity);
+        if (s->cfg.conductivity_float) {
+            s->coef_row = (source != NULL) ? coef_row_float_source : coef_row_float;
+        } else {
+            s->coef_row = (source != NULL) ? coef_row_double_source : coef_row_double;
+        }
+        free(own_conductivity);
+    }
+
+    init_field(s);
+    render_defaults(s);
+    return s;
+}
+
+heat_solver_t *heat_create(const heat_options_t *opts) {
+    return solver_init(opts, 0, 1);
+}
+
+#ifdef HEAT_WITH_MPI
+heat_solver_t *heat_create_mpi(const heat_options_t *opts, MPI_Comm comm) {
+    int rank, size, ok, all_ok;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    heat_solver_t *s = solver_init(opts, rank, size);
+
+    // Every rank fails together, or none does
+    ok = (s != NULL);
+    MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, comm);
+    if (!all_ok) {
+        heat_destroy(s);
+        return NULL;
+    }
+    MPI_Comm_dup(comm, &s->comm);
+    set_neighbours(s);
+    return s;
+}
+
+// Exchange ghost columns (packed, one message per neighbour)
+static void exchange_halo(heat_solver_t *s) {
+    double **u = s->u;
+    int i, nx = s->nx, last = s->local_ny - 1;
+
+    // Send first owned column to left, receive east ghost from right
+    for (i = 0; i < nx; i++) s->send_buf[i] = u[i][1];
+    MPI_Sendrecv(s->send_buf, nx, MPI_DOUBLE, s->left, 0,
+                 s->recv_buf, nx, MPI_DOUBLE, s->right, 0, s->comm, MPI_STATUS_IGNORE);
+    if (s->right != MPI_PROC_NULL) {
+        for (i = 0; i < nx; i++) u[i][last] = s->recv_buf[i];
+    }
+    // Send last owned column to right, receive west ghost from left
+    for (i = 0; i < nx; i++) s->send_buf[i] = u[i][last - 1];
+    MPI_Sendrecv(s->send_buf, nx, MPI_DOUBLE, s->right, 1,
+                 s->recv_buf, nx, MPI_DOUBLE, s->left, 1, s->comm, MPI_STATUS_IGNORE);
+    if (s->left != MPI_PROC_NULL) {
+        for (i = 0; i < nx; i++) u[i][0] = s->recv_buf[i];
+    }
+}
+#endif
+
+static void record_residual(heat_solver_t *s, double residual) {
+    if (s->num_residuals == s->max_residuals) {
+        s->max_residuals = (s->max_residuals > 0) ? 2 * s->max_residuals : 1024;
+        s->residuals = (double *)realloc(s->residuals, s->max_residuals * sizeof(double));
+    }
+    s->residuals[s->num_residuals++] = residual;
+}
+
+// Publish a snapshot: per-rank compute times are reduced to rank 0, which
+// writes the segment and the Prometheus file (collective)
+static void telemetry_snapshot(heat_solver_t *s, int state) {
+    double now = wall_time(), compute_max = s->interval_compute, compute_sum = s->interval_compute;
+
+#ifdef HEAT_WITH_MPI
+    if (s->comm != MPI_COMM_NULL) {
+        MPI_Reduce(&s->interval_compute, &compute_max, 1, MPI_DOUBLE, MPI_MAX, 0, s->comm);
+        MPI_Reduce(&s->interval_compute, &compute_sum, 1, MPI_DOUBLE, MPI_SUM, 0, s->comm);
+    }
+#endif
+    if (s->rank == 0) {
+        heat_metrics_t *m = &s->metrics;
+        double dt = now - s->interval_start;
+        m->iteration = s->num_residuals;
+        m->residual = (s->num_residuals > 0) ? s->residuals[s->num_residuals - 1] : 0.0;
+        m->elapsed = now - s->telemetry_start;
+        m->updates_per_second = (dt > 0.0) ? (double)(s->nx - 2) * (s->ny - 2) * s->interval_iter / dt : 0.0;
+        m->imbalance = (compute_sum > 0.0) ? compute_max * s->size / compute_sum : 1.0;
+        m->state = state;
+        if (s->telemetry != NULL) {
+            heat_telemetry_publish(s->telemetry, m);
+        }
+        if (s->prometheus_path[0] != '\0' && (now - s->last_prometheus >= 1.0 || state != HEAT_RUN_RUNNING)) {
+            heat_telemetry_prometheus(s->prometheus_path, s->run_name, m);
+            s->last_prometheus = now;
+        }
+    }
+    s->interval_start = now;
+    s->interval_compute = 0.0;
+    s->interval_iter = 0;
+}
+
+int heat_enable_telemetry(heat_solver_t *s, const char *run, const char *prometheus_path) {
+    if (run == NULL || run[0] == '\0') {
+        return 0;
+    }
+    s->telemetry_on = 1;
+    s->telemetry_start = s->interval_start = wall_time();
+    s->last_prometheus = -1e30;
+    snprintf(s->run_name, sizeof(s->run_name), "%s", run[0] == '/' ? run + 1 : run);
+    snprintf(s->prometheus_path, sizeof(s->prometheus_path), "%s", prometheus_path ? prometheus_path : "");
+    memset(&s->metrics, 0, sizeof(s->metrics));
+    s->metrics.ranks = s->size;
+    s->metrics.nx = s->nx;
+    s->metrics.ny = s->ny;
+    if (s->rank != 0) {
+        return 0;
+    }
+    heat_telemetry_name(s->telemetry_name, sizeof(s->telemetry_name), s->run_name);
+    s->telemetry = heat_telemetry_map(s->telemetry_name, 1);
+    if (s->telemetry == NULL) {
+        fprintf(stderr, "Warning: cannot create telemetry segment %s\n", s->telemetry_name);
+        return -1;
+    }
+    heat_telemetry_publish(s->telemetry, &s->metrics);
+    return 0;
+}
+
+// A frame pattern holds exactly one integer conversion (%d, %06d, ...)
+static int render_pattern_ok(const char *p) {
+    int conversions = 0;
+    for (; *p != '\0'; p++) {
+        if (*p != '%') continue;
+        if (*++p == '%') continue;
+        while (*p == '0' || *p == '-') p++;
+        while (*p >= '0' && *p <= '9') p++;
+        if (*p != 'd') return 0;
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+int heat_enable_render(heat_solver_t *s, const char *pattern, const char *options) {
+    char token[128], colormap[64] = "hot";
+    const char *p = options ? options : "";
+    int every = 100, downsample = 1, n;
+    double lo = 0.0, hi = 0.0;
+
+    if (pattern == NULL || pattern[0] == '\0') {
+        return 0;
+    }
+    if (strlen(pattern) >= sizeof(s->render_pattern) || !render_pattern_ok(pattern)) {
+        if (s->rank == 0) fprintf(stderr, "Error: frame pattern needs one %%d conversion: %s\n", pattern);
+        return -1;
+    }
+    while (sscanf(p, " %127s%n", token, &n) == 1) {
+        p += n;
+        if (sscanf(token, "every=%d", &every) == 1 && every > 0) continue;
+        if (sscanf(token, "downsample=%d", &downsample) == 1 && downsample > 0) continue;
+        if (sscanf(token, "colormap=%63s", colormap) == 1) continue;
+        if (sscanf(token, "range=%lf:%lf", &lo, &hi) == 2 && hi > lo) continue;
+        if (s->rank == 0) fprintf(stderr, "Error: bad render option '%s'\n", token);
+        return -1;
+    }
+    if (heat_colormap(colormap, &s->colormap) != 0) {
+        if (s->rank == 0) fprintf(stderr, "Error: unknown colormap '%s'\n", colormap);
+        return -1;
+    }
+
+    if (hi <= lo) {
+        render_range(&s->cfg, &lo, &hi);
+    }
+    strcpy(s->render_pattern, pattern);
+    s->render_every = every;
+    s->render_downsample = downsample;
+    s->render_lo = lo;
+    s->render_hi = hi;
+    s->render_last = -1;
+    return 0;
+}
+
+// Grid point sampled by pixel k when n points are shown at one pixel per d
+static int render_sample(int k, int d, int n) {
+    int p = k * d + d / 2;
+    return (p < n) ? p : n - 1;
+}
+
+int heat_render(heat_solver_t *s, const char *path) {
+    const int d = (s->render_downsample > 0) ? s->render_downsample : 1;
+    const int height = (s->nx + d - 1) / d, width = (s->ny + d - 1) / d;
+    const double lo = s->render_lo, scale = 255.0 / (s->render_hi - s->render_lo);
+    int first = s->start_y - 1 + (s->has_west ? 0 : 1);
+    int last = s->start_y - 1 + (s->has_east ? s->local_ny : s->local_ny - 1);
+    int p0 = 0, p1, ok = 1, i;
+
+    // This rank's tile: the pixel columns whose sample column it owns
+    while (p0 < width && render_sample(p0, d, s->ny) < first) p0++;
+    for (p1 = p0; p1 < width && render_sample(p1, d, s->ny) < last; p1++) {}
+    const int tile_w = p1 - p0;
+    unsigned char *tile = (unsigned char *)malloc((size_t)height * tile_w * 3 + 1);
+
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (i = 0; i < height; i++) {
+        const double *row = s->u[render_sample(i, d, s->nx)] - (s->start_y - 1);
+        unsigned char *out = tile + (size_t)i * tile_w * 3;
+        for (int k = 0; k < tile_w; k++) {
+            const unsigned char *c = s->colormap.rgb[heat_colormap_index(row[render_sample(p0 + k, d, s->ny)], lo, scale)];
+            out[3 * k] = c[0];
+            out[3 * k + 1] = c[1];
+            out[3 * k + 2] = c[2];
+        }
+    }
+
+    unsigned char *image = tile;
+#ifdef HEAT_WITH_MPI
+    if (s->comm != MPI_COMM_NULL) {
+        // Composite on rank 0: gather the tiles, then place them side by side
+        int span[2] = { p0, tile_w }, *spans = NULL, *counts = NULL, *displs = NULL;
+        unsigned char *tiles = NULL;
+        if (s->rank == 0) {
+            spans = (int *)malloc(4 * s->size * sizeof(int));
+            counts = spans + 2 * s->size;
+            displs = spans + 3 * s->size;
+        }
+        MPI_Gather(span, 2, MPI_INT, spans, 2, MPI_INT, 0, s->comm);
+        if (s->rank == 0) {
+            long total = 0;
+            for (int r = 0; r < s->size; r++) {
+                counts[r] = height * spans[2 * r + 1] * 3;
+                displs[r] = (int)total;
+                total += counts[r];
+            }
+            tiles = (unsigned char *)malloc(total + 1);
+        }
+        MPI_Gatherv(tile, height * tile_w * 3, MPI_UNSIGNED_CHAR,
+                    tiles, counts, displs, MPI_UNSIGNED_CHAR, 0, s->comm);
+        if (s->rank == 0) {
+            image = (unsigned char *)malloc((size_t)width * height * 3);
+            for (int r = 0; r < s->size; r++) {
+                const int w = spans[2 * r + 1];
+                for (i = 0; i < height; i++) {
+                    memcpy(image + ((size_t)i * width + spans[2 * r]) * 3,
+                           tiles + displs[r] + (size_t)i * w * 3, (size_t)w * 3);
+                }
+            }
+            free(tiles);
+            free(spans);
+        }
+    }
+#endif
+
+    if (s->rank == 0) {
+        ok = (heat_image_write(path, image, width, height) == 0);
+        if (!ok) fprintf(stderr, "Warning: cannot write frame %s\n", path);
+    }
+    if (image != tile) free(image);
+    free(tile);
+#ifdef HEAT_WITH_MPI
+    if (s->comm != MPI_COMM_NULL) {
+        MPI_Bcast(&ok, 1, MPI_INT, 0, s->comm);
+    }
+#endif
+    return ok ? 0 : -1;
+}
+
+// Frame for the current iteration, at most one per iteration
+static void render_frame(heat_solver_t *s) {
+    char path[sizeof(s->render_pattern) + 32];
+    if (s->render_last == s->num_residuals) return;
+    snprintf(path, sizeof(path), s->render_pattern, s->num_residuals);
+    heat_render(s, path);
+    s->render_last = s->num_residuals;
+}
+
+#ifdef HEAT_WITH_MPI
+static int analytics_count(const heat_solver_t *s) {
+    return ANALYTICS_FIXED + s->analytics.bins + s->analytics.levels;
+}
+
+static void analytics_combine(void *in, void *inout, int *len, MPI_Datatype *type) {
+    const double *a = (const double *)in;
+    double *b = (double *)inout;
+    (void)type;
+    for (int k = 0; k < *len; k++) {
+        b[k] = (k < ANALYTICS_NMAX) ? fmax(a[k], b[k]) : a[k] + b[k];
+    }
+}
+#endif
+
+// Comma-separated list of doubles; returns the count, or -1 if malformed
+static int parse_list(const char *p, double *out, int max) {
+    int n = 0;
+    while (*p != '\0') {
+        char *end;
+        if (n == max) return -1;
+        out[n++] = strtod(p, &end);
+        if (end == p || (*end != ',' && *end != '\0')) return -1;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return n;
+}
+
+static int parse_stats(const char *p) {
+    static const char *names[] = { "moments", "histogram", "isotherms", "flux" };
+    int stats = 0;
+    while (*p != '\0') {
+        size_t len = strcspn(p, ",");
+        int k;
+        for (k = 0; k < 4; k++) {
+            if (strlen(names[k]) == len && strncmp(p, names[k], len) == 0) break;
+        }
+        if (k == 4) return -1;
+        stats |= 1 << k;
+        p += len + (p[len] == ',');
+    }
+    return stats;
+}
+
+int heat_enable_analytics(heat_solver_t *s, const char *path, const char *options) {
+    heat_analytics_t *a = &s->analytics;
+    char token[256];
+    const char *p = options ? options : "";
+    int every = 100, n, ok = 1;
+
+    if (path == NULL) {
+        return 0;
+    }
+    memset(a, 0, sizeof(*a));
+    a->stats = HEAT_STAT_ALL;
+    a->bins = 16;
+    a->levels = -1;
+    while (sscanf(p, " %255s%n", token, &n) == 1) {
+        p += n;
+        if (sscanf(token, "every=%d", &every) == 1 && every > 0) continue;
+        if (strncmp(token, "stats=", 6) == 0 && (a->stats = parse_stats(token + 6)) > 0) continue;
+        if (sscanf(token, "bins=%d", &a->bins) == 1 && a->bins > 0 && a->bins <= HEAT_ANALYTICS_MAX_BINS) continue;
+        if (sscanf(token, "range=%lf:%lf", &a->lo, &a->hi) == 2 && a->hi > a->lo) continue;
+        if (strncmp(token, "levels=", 7) == 0 &&
+            (a->levels = parse_list(token + 7, a->level, HEAT_ANALYTICS_MAX_LEVELS)) > 0) continue;
+        if (s->rank == 0) fprintf(stderr, "Error: bad analytics option '%s'\n", token);
+        return -1;
+    }
+    if (a->hi <= a->lo) {
+        render_range(&s->cfg, &a->lo, &a->hi);
+    }
+    if (a->levels < 0) {
+        a->levels = 3;
+        for (int k = 0; k < 3; k++) a->level[k] = a->lo + (k + 1) * (a->hi - a->lo) / 4;
+    }
+    if (!(a->stats & HEAT_STAT_HISTOGRAM)) a->bins = 0;
+    if (!(a->stats & HEAT_STAT_ISOTHERMS)) a->levels = 0;
+
+    // Rank 0 writes the time series header
+    if (s->rank == 0 && path[0] != '\0') {
+        s->analytics_out = fopen(path, "w");
+        ok = (s->analytics_out != NULL);
+        if (!ok) {
+            fprintf(stderr, "Error: cannot open analytics file %s\n", path);
+        } else {
+            FILE *out = s->analytics_out;
+            fprintf(out, "iteration,residual");
+            if (a->stats & HEAT_STAT_MOMENTS) fprintf(out, ",l2_residual,mean,min,max");
+            for (int e = 0; (a->stats & HEAT_STAT_FLUX) && e < NUM_EDGES; e++) {
+                fprintf(out, ",flux_%s", heat_edge_name(e));
+            }
+            for (int k = 0; k < a->levels; k++) fprintf(out, ",crossings_%g", a->level[k]);
+            for (int b = 0; b < a->bins; b++) fprintf(out, ",bin_%g", a->lo + b * (a->hi - a->lo) / a->bins);
+            fprintf(out, "\n");
+        }
+    }
+#ifdef HEAT_WITH_MPI
+    if (s->comm != MPI_COMM_NULL) {
+        MPI_Bcast(&ok, 1, MPI_INT, 0, s->comm);
+        if (s->analytics_op == MPI_OP_NULL) {
+            MPI_Op_create(analytics_combine, 1, &s->analytics_op);
+        }
+    }
+#endif
+    if (!ok) return -1;
+    s->analytics_every = every;
+    s->have_analytics = 0;
+    return 0;
+}
+
+const heat_analytics_t *heat_analytics(const heat_solver_t *s) {
+    return s->have_analytics ? &s->analytics : NULL;
+}
+
+// Jacobi sweep of a check iteration with the analytics fused in: each row is
+// updated and then, while it is still in cache, reduced for the moments and the
+// squared change, the histogram and the isotherm crossings; edge
+// fluxes on the first/last rows and columns. Leaves the local partials in
+// analytics_buf and returns the local max change.
+static double sweep_analytics(heat_solver_t *s) {
+    double **u = s->u, **u_new = s->u_new;
+    const heat_analytics_t *a = &s->analytics;
+    const int nx = s->nx, ny = s->local_ny, stats = a->stats, bins = a->bins, levels = a->levels;
+    const int jh = s->has_east ? ny - 2 : ny - 1;      // Horizontal edges (j, j + 1), j < jh
+    const int has_west = s->has_west, has_east = s->has_east;
+    const double lo = a->lo, bin_scale = bins / (a->hi - a->lo);
+    double max_diff = 0.0, vmax = -HUGE_VAL, vmin = HUGE_VAL, sum = 0.0, sq = 0.0;
+    double flux[NUM_EDGES] = { 0.0 };
+    long hist[HEAT_ANALYTICS_MAX_BINS] = { 0 }, cross[HEAT_ANALYTICS_MAX_LEVELS] = { 0 };
+    int i;
+
+#ifdef _OPENMP
+    #pragma omp parallel for reduction(max:max_diff, vmax) reduction(min:vmin) \
+        reduction(+:sum, sq, flux[:NUM_EDGES], hist[:HEAT_ANALYTICS_MAX_BINS], cross[:HEAT_ANALYTICS_MAX_LEVELS])
+#endif
+    for (i = 1; i < nx - 1; i++) {
+        const double *up = u[i - 1], *row = u[i], *down = u[i + 1];
+        const double *out = u_new[i];
+        int j;
+
+        // Same row kernel as the plain sweep, then the moments of the row just
+        // swept while it is in cache
+        double d = (s->coef_row != NULL) ? s->coef_row(s, i)
+                 : (s->local_source != NULL)
+                 ? heat_sweep_row(u, u_new, s->local_source, s->ny, i, 1, ny - 1, 1)
+                 : heat_sweep_row(u, u_new, NULL, s->ny, i, 1, ny - 1, 0);
+        max_diff = (d > max_diff) ? d : max_diff;
+#ifdef _OPENMP
+        #pragma omp simd reduction(max:vmax) reduction(min:vmin) reduction(+:sum, sq)
+#endif
+        for (j = 1; j < ny - 1; j++) {
+            double v = row[j], dv = out[j] - v;
+            sq += dv * dv;
+            sum += v;
+            vmax = (v > vmax) ? v : vmax;
+            vmin = (v < vmin) ? v : vmin;
+        }
+        if (stats & HEAT_STAT_HISTOGRAM) {
+            for (j = 1; j < ny - 1; j++) {
+                double x = (row[j] - lo) * bin_scale;
+                hist[(x < 0.0) ? 0 : (x >= bins) ? bins - 1 : (int)x]++;
+            }
+        }
+        if (stats & HEAT_STAT_ISOTHERMS) {
+            for (int k = 0; k < levels; k++) {
+                const double t = a->level[k];
+                double c = 0.0;     // Counted in doubles: the compare masks vectorize
+                for (j = 1; j < jh; j++) c += (double)((row[j] < t) != (row[j + 1] < t));
+                if (i < nx - 2) {
+                    for (j = 1; j < ny - 1; j++) c += (double)((row[j] < t) != (down[j] < t));
+                }
+                cross[k] += (long)c;
+            }
+        }
+        if (stats & HEAT_STAT_FLUX) {
+            if (i == 1) {
+                for (j = 1; j < ny - 1; j++) flux[EDGE_NORTH] += up[j] - row[j];
+            }
+            if (i == nx - 2) {
+                for (j = 1; j < ny - 1; j++) flux[EDGE_SOUTH] += down[j] - row[j];
+            }
+            if (has_west) flux[EDGE_WEST] += row[0] - row[1];
+            if (has_east) flux[EDGE_EAST] += row[ny - 1] - row[ny - 2];
+        }
+    }
+
+    double *buf = s->analytics_buf;
+    buf[0] = max_diff;
+    buf[1] = vmax;
+    buf[2] = -vmin;
+    buf[3] = sum;
+    buf[4] = sq;
+    for (int e = 0; e < NUM_EDGES; e++) buf[5 + e] = flux[e];
+    for (int b = 0; b < bins; b++) buf[ANALYTICS_FIXED + b] = (double)hist[b];
+    for (int k = 0; k < levels; k++) buf[ANALYTICS_FIXED + bins + k] = (double)cross[k];
+    return max_diff;
+}
+
+// Unpack the reduced partials into the record and append it to the time series
+static void analytics_record(heat_solver_t *s) {
+    heat_analytics_t *a = &s->analytics;
+    const double *buf = s->analytics_buf;
+
+    a->iteration = s->num_residuals;
+    a->residual = buf[0];
+    a->max = buf[1];
+    a->min = -buf[2];
+    a->mean = buf[3] / ((double)(s->nx - 2) * (s->ny - 2));
+    a->l2_residual = sqrt(buf[4]);
+    for (int e = 0; e < NUM_EDGES; e++) a->flux[e] = buf[5 + e];
+    for (int b = 0; b < a->bins; b++) a->histogram[b] = (long)buf[ANALYTICS_FIXED + b];
+    for (int k = 0; k < a->levels; k++) a->crossings[k] = (long)buf[ANALYTICS_FIXED + a->bins + k];
+    s->have_analytics = 1;
+
+    FILE *out = s->analytics_out;
+    if (out == NULL) return;
+    fprintf(out, "%d,%.6e", a->iteration, a->residual);
+    if (a->stats & HEAT_STAT_MOMENTS) {
+        fprintf(out, ",%.6e,%.6f,%.6f,%.6f", a->l2_residual, a->mean, a->min, a->max);
+    }
+    for (int e = 0; (a->stats & HEAT_STAT_FLUX) && e < NUM_EDGES; e++) fprintf(out, ",%.6f", a->flux[e]);
+    for (int k = 0; k < a->levels; k++) fprintf(out, ",%ld", a->crossings[k]);
+    for (int b = 0; b < a->bins; b++) fprintf(out, ",%ld", a->histogram[b]);
+    fprintf(out, "\n");
+    fflush(out);
+}
+
+// One Jacobi iteration; returns the global residual
+static double iterate(heat_solver_t *s) {
+    double **u = s->u, **u_new = s->u_new;
+    double max_diff, t[5] = { 0.0 };
+    int i, j;
+    const int check = s->analytics_every > 0 && (s->num_residuals + 1) % s->analytics_every == 0;
+
+    if (s->telemetry_on) t[0] = wall_time();
+#ifdef HEAT_WITH_MPI
+    if (s->comm != MPI_COMM_NULL) {
+        exchange_halo(s);
+    }
+#endif
+    if (s->telemetry_on) t[1] = wall_time();
+
+    // Compute new values (kernel chosen from the config; analytics fused in on checks)
+    if (check) {
+        max_diff = sweep_analytics(s);
+    } else if (s->coef_row != NULL) {
+        max_diff = coef_sweep(s);
+    } else {
+        max_diff = s->sweep(u, u_new, s->local_source, s->ny, 1, s->nx - 1, 1, s->local_ny - 1);
+    }
+    if (s->telemetry_on) t[2] = wall_time();
+
+    // Update u; edges and ghosts stay in place for the boundary conditions
+#ifdef _OPENMP
+    #pragma omp parallel for private(i, j) collapse(2)
+#endif
+    for (i = 1; i < s->nx - 1; i++) {
+        for (j = 1; j < s->local_ny - 1; j++) {
+            u[i][j] = u_new[i][j];
+        }
+    }
+    heat_apply_bc(&s->cfg, u, s->nx, s->local_ny, s->has_west, s->has_east);
+    if (s->telemetry_on) t[3] = wall_time();
+
+#ifdef HEAT_WITH_MPI
+    // Global reduction to find maximum difference; on checks the analytics
+    // partials travel in the same reduction
+    if (s->comm != MPI_COMM_NULL) {
+        if (check) {
+            MPI_Allreduce(MPI_IN_PLACE, s->analytics_buf, analytics_count(s), MPI_DOUBLE,
+                          s->analytics_op, s->comm);
+            max_diff = s->analytics_buf[0];
+        } else {
+            MPI_Allreduce(MPI_IN_PLACE, &max_diff, 1, MPI_DOUBLE, MPI_MAX, s->comm);
+        }
+    }
+#endif
+    record_residual(s, max_diff);
+    if (check) {
+        analytics_record(s);
+    }
+
+    if (s->telemetry_on) {
+        t[4] = wall_time();
+        for (int p = 0; p < HEAT_NUM_PHASES; p++) {
+            s->metrics.phase_seconds[p] += t[p + 1] - t[p];
+        }
+        s->interval_compute += t[3] - t[1];
+        s->interval_iter++;
+        if (s->num_residuals % HEAT_TELEMETRY_EVERY == 0) {
+            telemetry_snapshot(s, HEAT_RUN_RUNNING);
+        }
+    }
+    if (s->render_every > 0 && s->num_residuals % s->render_every == 0) {
+        render_frame(s);
+    }
+    return max_diff;
+}
+
+void heat_reset(heat_solver_t *s, const heat_config_t *config) {
+    heat_config_t cfg = *config;
+
+    // Source and conductivity were fixed at creation
+    memcpy(cfg.source_file, s->cfg.source_file, sizeof(cfg.source_file));
+    memcpy(cfg.conductivity_file, s->cfg.conductivity_file, sizeof(cfg.conductivity_file));
+    cfg.conductivity_float = s->cfg.conductivity_float;
+    s->cfg = cfg;
+#ifdef HEAT_WITH_MPI
+    if (s->comm != MPI_COMM_NULL) {
+        set_neighbours(s);
+    }
+#endif
+    init_field(s);
+    s->render_last = -1;
+}
+
+// Nonzero if the progress hook asks to stop
+static int report_progress(heat_solver_t *s, double residual) {
+    if (s->progress == NULL || s->num_residuals % s->progress_every != 0) {
+        return 0;
+    }
+    return s->progress(s->progress_user, s->num_residuals, residual);
+}
+
+void heat_set_progress(heat_solver_t *s, int every, heat_progress_fn fn, void *user) {
+    s->progress = fn;
+    s->progress_user = user;
+    s->progress_every = (every > 0) ? every : 1;
+}
+
+double heat_step(heat_solver_t *s, int n) {
+    double residual = 0.0;
+    for (int iter = 0; iter < n; iter++) {
+        residual = iterate(s);
+        if (report_progress(s, residual)) {
+            break;
+        }
+    }
+    return residual;
+}
+
+int heat_solve(heat_solver_t *s, int max_iter, double tol) {
+    for (int iter = 0; iter < max_iter; iter++) {
+        double residual = iterate(s);
+        if (residual < tol) {
+            if (s->telemetry_on) {
+                telemetry_snapshot(s, HEAT_RUN_CONVERGED);
+            }
+            if (s->render_every > 0) {
+                render_frame(s);
+            }
+            return iter;
+        }
+        if (report_progress(s, residual)) {
+            break;
+        }
+    }
+    if (s->render_every > 0) {
+        render_frame(s);
+    }
+    return -1;
+}
+
+heat_field_t heat_field(const heat_solver_t *s) {
+    heat_field_t f;
+    f.data = s->u[0];
+    f.nx = s->nx;
+    f.ny = s->local_ny;
+    f.stride = (long)heat_arena_stride(s->local_ny);
+    f.global_i0 = 0;
+    f.global_j0 = s->start_y - 1;
+    f.owned_j0 = s->has_west ? 0 : 1;
+    f.owned_j1 = s->has_east ? s->local_ny : s->local_ny - 1;
+    return f;
+}
+
+const double *heat_residuals(const heat_solver_t *s, int *count) {
+    *count = s->num_residuals;
+    return s->residuals;
+}
+
+double heat_interior_average(const heat_solver_t *s) {
+    double sum = 0.0;
+    for (int i = 1; i < s->nx - 1; i++) {
+        for (int j = 1; j < s->local_ny - 1; j++) {
+            sum += s->u[i][j];
+        }
+    }
+#ifdef HEAT_WITH_MPI
+    if (s->comm != MPI_COMM_NULL) {
+        MPI_Allreduce(MPI_IN_PLACE, &sum, 1, MPI_DOUBLE, MPI_SUM, s->comm);
+    }
+#endif
+    return sum / ((double)(s->nx - 2) * (s->ny - 2));
+}
+
+void heat_memory_report(const heat_solver_t *s, FILE *out) {
+    heat_arena_report(&s->arena, out);
+}
+
+void heat_destroy(heat_solver_t *s) {
+    if (s == NULL) return;
+    if (s->telemetry != NULL) {
+        // The segment outlives the solver so heat_top can show the final
+        // state; heat_top --clean removes it
+        s->metrics.iteration = s->num_residuals;
+        s->metrics.residual = (s->num_residuals > 0) ? s->residuals[s->num_residuals - 1] : 0.0;
+        s->metrics.elapsed = wall_time() - s->telemetry_start;
+        if (s->metrics.state != HEAT_RUN_CONVERGED) {
+            s->metrics.state = HEAT_RUN_FINISHED;
+        }
+        heat_telemetry_publish(s->telemetry, &s->metrics);
+        if (s->prometheus_path[0] != '\0') {
+            heat_telemetry_prometheus(s->prometheus_path, s->run_name, &s->metrics);
+        }
+        heat_telemetry_unmap(s->telemetry);
+    }
+    if (s->analytics_out != NULL) {
+        fclose(s->analytics_out);
+    }
+#ifdef HEAT_WITH_MPI
+    if (s->analytics_op != MPI_OP_NULL) {
+        MPI_Op_free(&s->analytics_op);
+    }
+    if (s->comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&s->comm);
+    }
+#endif
+    heat_arena_free(&s->arena);
+    free(s->own_source);
+    free(s->residuals);
+    free(s);
+}
@@ -0,0 +1,179 @@
+#ifndef LIBHEAT_H
+#define LIBHEAT_H
+
+#include "heat_config.h"
+
+#if defined(HEAT_WITH_MPI) && !defined(MPI_VERSION)
+#include <mpi.h>
+#endif
+
+// Embeddable Jacobi solver for the 2D steady-state heat equation.
+//
+// The solver that heat_serial and heat_parallel used to run inside main():
+// boundary conditions, source term and an optional conductivity map (harmonic-
+// mean face coefficients, precomputed) from a heat_config_t, huge-page arena
+// grids, column decomposition with packed halo exchange under MPI. A solver is
+// created once, advanced in as many calls as the caller likes, and its field
+// is read (or written) in place through a pointer/stride view.
+//
+// Two builds of the same source: libheat.a has the serial context only;
+// libheat_mpi.a (compiled with HEAT_WITH_MPI) adds heat_create_mpi. All calls
+// on an MPI solver are collective over its communicator.
+//
+//     heat_options_t opts;
+//     heat_options_default(&opts, 500, 500);
+//     heat_solver_t *s = heat_create(&opts);
+//     int iter = heat_solve(s, 1000, 1e-6);
+//     heat_field_t f = heat_field(s);      // f.data[i * f.stride + j]
+//     heat_destroy(s);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct heat_solver heat_solver_t;
+
+typedef struct {
+    int nx, ny;                 // Global grid size, edges included
+    heat_config_t config;       // Boundary conditions; source_file and
+                                // conductivity_file are loaded on create
+    const double *source;       // Optional nx*ny source field, row-major, used instead
+                                // of config.source_file; must outlive the solver
+    const double *conductivity; // Optional nx*ny positive conductivity, row-major, used
+                                // instead of config.conductivity_file; read on create only
+} heat_options_t;
+
+// View of the local block: point (i, j) is data[i * stride + j], i.e. global
+// point (global_i0 + i, global_j0 + j). Columns [owned_j0, owned_j1) belong to
+// this rank (global edges included), so the owned columns of all ranks tile
+// the global grid exactly once. The rest are ghost columns.
+typedef struct {
+    double *data;
+    int nx, ny;
+    long stride;
+    int global_i0, global_j0;
+    int owned_j0, owned_j1;
+} heat_field_t;
+
+// Progress hook: called every `every` iterations with the number of iterations
+// since creation and the latest global residual. A nonzero return stops
+// heat_step/heat_solve after that iteration; under MPI every rank must return
+// the same value.
+typedef int (*heat_progress_fn)(void *user, int iteration, double residual);
+
+// Defaults: nx x ny grid, Dirichlet 100.0 on every edge, no source
+void heat_options_default(heat_options_t *opts, int nx, int ny);
+
+// Serial solver; returns NULL on error
+heat_solver_t *heat_create(const heat_options_t *opts);
+
+#if defined(HEAT_WITH_MPI) || defined(MPI_VERSION)
+// Solver decomposed over the ranks of comm (collective; comm is duplicated)
+heat_solver_t *heat_create_mpi(const heat_options_t *opts, MPI_Comm comm);
+#endif
+
+// New boundary conditions on the same grids: the field restarts from its
+// initial state and the residual history is cleared. The source term and the
+// conductivity (and their config file settings) are left as they were at
+// creation.
+void heat_reset(heat_solver_t *s, const heat_config_t *config);
+
+// Publish live metrics to the shared-memory segment /heat_<run> (read with
+// heat_top) and, if prometheus_path is not NULL, to a Prometheus text file
+// refreshed at most once a second. A NULL run leaves telemetry off.
+// The segment stays after heat_destroy with the final state ("converged" or
+// "finished") until heat_top --clean removes it; reusing the run name
+// overwrites it. Collective; returns -1 if rank 0 cannot create the segment.
+int heat_enable_telemetry(heat_solver_t *s, const char *run, const char *prometheus_path);
+
+// Render colormapped frames in situ: every `every` iterations, and when
+// heat_solve stops, the field is written to the file named by pattern with
+// the iteration count filled in ("frame_%06d.png"; names ending in .ppm
+// write PPM). Each rank colour-maps its own columns and rank 0 composites the
+// tiles and encodes the image. options is a space-separated list of
+//     every=N        iterations between frames (100)
+//     downsample=D   one pixel per D x D grid points (1)
+//     colormap=NAME  hot, inferno, coolwarm or gray (hot)
+//     range=LO:HI    fixed colour scale (default: 0 and the Dirichlet values)
+// A NULL pattern leaves rendering off. Collective; returns -1 on a bad
+// pattern or option.
+int heat_enable_render(heat_solver_t *s, const char *pattern, const char *options);
+
+// Write one frame of the current field to path now (collective)
+int heat_render(heat_solver_t *s, const char *path);
+
+#define HEAT_ANALYTICS_MAX_BINS 64
+#define HEAT_ANALYTICS_MAX_LEVELS 8
+
+enum {
+    HEAT_STAT_MOMENTS = 1,      // mean, min, max, L2 residual
+    HEAT_STAT_HISTOGRAM = 2,
+    HEAT_STAT_ISOTHERMS = 4,    // grid edges each isotherm crosses
+    HEAT_STAT_FLUX = 8,         // heat through each domain edge
+    HEAT_STAT_ALL = 15
+};
+
+// One analytics record. Field statistics describe the interior field the
+// iteration started from; the residuals describe its update.
+typedef struct {
+    int iteration;              // Iterations since creation, this one included
+    int stats;                  // HEAT_STAT_* groups computed
+    double residual;            // max |u_new - u|
+    double l2_residual;         // sqrt(sum (u_new - u)^2)
+    double mean, min, max;
+    double flux[NUM_EDGES];     // Into the domain: sum of (edge - adjacent interior)
+    int bins, levels;
+    double lo, hi;              // Histogram range; outliers go to the end bins
+    double level[HEAT_ANALYTICS_MAX_LEVELS];
+    long histogram[HEAT_ANALYTICS_MAX_BINS];
+    long crossings[HEAT_ANALYTICS_MAX_LEVELS];
+} heat_analytics_t;
+
+// Fused in-situ analytics: every `every` iterations the sweep itself also
+// accumulates the selected statistics, with no extra pass over the grid, and
+// they travel in the iteration's single MPI reduction. Rank 0 appends one CSV
+// line per record to path; an empty path keeps the records in memory only
+// (heat_analytics()), and NULL leaves analytics off.
+// options is a space-separated list of
+//     every=N               iterations between records (100)
+//     stats=a,b,...         moments, histogram, isotherms, flux (all)
+//     bins=B                histogram bins (16)
+//     range=LO:HI           histogram range (default: 0 and the Dirichlet values)
+//     levels=T1,T2,...      isotherm temperatures (quarter points of the range)
+// Collective; returns -1 on a bad option or if the file cannot be opened.
+int heat_enable_analytics(heat_solver_t *s, const char *path, const char *options);
+
+// Latest analytics record, the same on every rank; NULL before the first
+const heat_analytics_t *heat_analytics(const heat_solver_t *s);
+
+// Install (or with fn == NULL remove) the progress hook
+void heat_set_progress(heat_solver_t *s, int every, heat_progress_fn fn, void *user);
+
+// Advance n iterations; returns the global residual (max |u_new - u|) of the last one
+double heat_step(heat_solver_t *s, int n);
+
+// Iterate until the residual drops below tol or max_iter iterations have run.
+// Returns the iteration of this call that converged (from 0), or -1 if it did
+// not converge or the progress hook stopped it.
+int heat_solve(heat_solver_t *s, int max_iter, double tol);
+
+// Zero-copy view of the current field; valid until heat_destroy. Writing
+// interior points sets the starting guess of the next step.
+heat_field_t heat_field(const heat_solver_t *s);
+
+// Residual of every iteration since creation; *count receives the length
+const double *heat_residuals(const heat_solver_t *s, int *count);
+
+// Average of the global interior points (collective)
+double heat_interior_average(const heat_solver_t *s);
+
+// Size and page backing of the solver's memory arena
+void heat_memory_report(const heat_solver_t *s, FILE *out);
+
+void heat_destroy(heat_solver_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
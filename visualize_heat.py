@@ -1,22 +1,61 @@
 """
 VTK Visualization Script for 2D Heat Equation
-This script reads the VTK output file and creates visualizations
+This script solves in-process through the heat module when it is built,
+or reads the VTK output file, and creates visualizations
 """
 
 import vtk
 import sys
 
-def visualize_heat_distribution(filename='heat_output.vtk'):
+def solve_in_process(nx=500, ny=500, config=None):
     """
-    Visualize the heat distribution from a VTK file
+    Run the solver in this process through the heat extension module
+    (build it with `make python`) instead of reading a VTK file
+
+    Returns:
+        solver: heat.Solver holding the converged field
+    """
+    import heat
+    solver = heat.Solver(nx, ny, config=config)
+    solver.solve(1000, 1e-6,
+                 callback=lambda it, res: print(f"  iteration {it}: residual {res:.3e}"),
+                 every=200)
+    return solver
+
+def load_heat_data(source='heat_output.vtk'):
+    """
+    Get the temperature field from a VTK file or a heat.Solver
+
+    Returns:
+        image: vtkImageData with x varying fastest, like the VTK file
+    """
+    if isinstance(source, str):
+        reader = vtk.vtkStructuredPointsReader()
+        reader.SetFileName(source)
+        reader.Update()
+        return reader.GetOutput()
+
+    import numpy as np
+    from vtk.util import numpy_support
+
+    # The solver's grid is indexed [x, y]; its transpose is [y, x]
+    data = np.ascontiguousarray(np.asarray(source).T)
+    ny, nx = data.shape
+    scalars = numpy_support.numpy_to_vtk(data.ravel(), deep=True)
+    scalars.SetName("temperature")
+    image = vtk.vtkImageData()
+    image.SetDimensions(nx, ny, 1)
+    image.GetPointData().SetScalars(scalars)
+    return image
+
+def visualize_heat_distribution(source='heat_output.vtk'):
+    """
+    Visualize the heat distribution from a VTK file or a heat.Solver
     
     Args:
-        filename: Path to the VTK file
+        source: Path to the VTK file, or a heat.Solver
     """
-    # Read data from file
-    reader = vtk.vtkStructuredPointsReader()
-    reader.SetFileName(filename)
-    reader.Update()
+    image = load_heat_data(source)
     
     # Create a lookup table for temperature colors (blue to red)
     lut = vtk.vtkLookupTable()
@@ -26,7 +65,7 @@ def visualize_heat_distribution(filename='heat_output.vtk'):
     
     # Create a mapper
     mapper = vtk.vtkDataSetMapper()
-    mapper.SetInputConnection(reader.GetOutputPort())
+    mapper.SetInputData(image)
     mapper.SetLookupTable(lut)
     mapper.SetScalarRange(0, 100)  # Temperature range
     
@@ -65,18 +104,15 @@ def visualize_heat_distribution(filename='heat_output.vtk'):
     render_window.Render()
     interactor.Start()
 
-def save_visualization_image(filename='heat_output.vtk', output_image='heat_visualization.png'):
+def save_visualization_image(source='heat_output.vtk', output_image='heat_visualization.png'):
     """
     Save the visualization as an image file
     
     Args:
-        filename: Path to the VTK file
+        source: Path to the VTK file, or a heat.Solver
         output_image: Path to save the output image
     """
-    # Read data from file
-    reader = vtk.vtkStructuredPointsReader()
-    reader.SetFileName(filename)
-    reader.Update()
+    image = load_heat_data(source)
     
     # Create a lookup table
     lut = vtk.vtkLookupTable()
@@ -86,7 +122,7 @@ def save_visualization_image(filename='heat_output.vtk', output_image='heat_visu
     
     # Create a mapper
     mapper = vtk.vtkDataSetMapper()
-    mapper.SetInputConnection(reader.GetOutputPort())
+    mapper.SetInputData(image)
     mapper.SetLookupTable(lut)
     mapper.SetScalarRange(0, 100)
     
@@ -134,17 +170,25 @@ def save_visualization_image(filename='heat_output.vtk', output_image='heat_visu
     print(f"Visualization saved to: {output_image}")
 
 if __name__ == "__main__":
+    # A file named on the command line is read; otherwise prefer solving
+    # in-process when the extension module is available
     if len(sys.argv) > 1:
-        vtk_file = sys.argv[1]
+        source = sys.argv[1]
     else:
-        vtk_file = 'heat_output.vtk'
+        try:
+            source = solve_in_process()
+            print("Solved in-process with the heat module")
+        except ImportError:
+            source = 'heat_output.vtk'
+            print("heat module not built (make python); using the VTK file")
     
-    print(f"Reading VTK file: {vtk_file}")
+    if isinstance(source, str):
+        print(f"Reading VTK file: {source}")
     
     # Save image first
-    save_visualization_image(vtk_file, 'heat_visualization.png')
+    save_visualization_image(source, 'heat_visualization.png')
     
     # Then display interactive window
     print("Launching interactive visualization...")
     print("Press 'q' to quit the visualization window")
-    visualize_heat_distribution(vtk_file)
+    visualize_heat_distribution(source)
@@ -46,15 +46,44 @@ def read_vtk_file(filename='heat_output.vtk'):
     
     return nx, ny, data
 
+def solve_in_process(nx=500, ny=500, config=None):
+    """
+    Run the solver in this process through the heat extension module
+    (build it with `make python`) instead of reading a VTK file
+
+    Returns:
+        solver: heat.Solver holding the converged field
+    """
+    import heat
+    solver = heat.Solver(nx, ny, config=config)
+    solver.solve(1000, 1e-6,
+                 callback=lambda it, res: print(f"  iteration {it}: residual {res:.3e}"),
+                 every=200)
+    return solver
+
+def load_heat_data(source='heat_output.vtk'):
+    """
+    Get the temperature field from a VTK file or a heat.Solver
+
+    Returns:
+        nx, ny: Grid dimensions
+        data: 2D numpy array indexed [y, x], like the VTK reader
+    """
+    if isinstance(source, str):
+        return read_vtk_file(source)
+    # Zero-copy view of the solver's grid, which is indexed [x, y]
+    data = np.asarray(source).T
+    return data.shape[1], data.shape[0], data
+
 def visualize_heat_colab(filename='heat_output.vtk'):
     """
     Create visualization suitable for Google Colab
     
     Args:
-        filename: Path to the VTK file
+        filename: Path to the VTK file, or a heat.Solver
     """
     # Read data
-    nx, ny, data = read_vtk_file(filename)
+    nx, ny, data = load_heat_data(filename)
     
     # Create figure
     fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(15, 5))
@@ -97,10 +126,10 @@ def plot_cross_sections(filename='heat_output.vtk'):
     Plot cross-sections of the temperature distribution
     
     Args:
-        filename: Path to the VTK file
+        filename: Path to the VTK file, or a heat.Solver
     """
     # Read data
-    nx, ny, data = read_vtk_file(filename)
+    nx, ny, data = load_heat_data(filename)
     
     # Create figure for cross-sections
     fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(15, 5))
@@ -134,13 +163,21 @@ if __name__ == "__main__":
     
     vtk_file = 'heat_output.vtk'
     
-    # Check if file exists
+    # Prefer solving in-process when the extension module is available
     import os
-    if not os.path.exists(vtk_file):
+    try:
+        source = solve_in_process()
+        print("Solved in-process with the heat module\n")
+    except ImportError:
+        source = vtk_file
+        print("heat module not built (make python); using the VTK file\n")
+
+    if isinstance(source, str) and not os.path.exists(source):
         print(f"Error: File {vtk_file} not found!")
         print("Please ensure the VTK file is uploaded or generated first.")
     else:
-        print(f"Reading data from: {vtk_file}\n")
-        visualize_heat_colab(vtk_file)
+        if isinstance(source, str):
+            print(f"Reading data from: {vtk_file}\n")
+        visualize_heat_colab(source)
         print("\n")
-        plot_cross_sections(vtk_file)
+        plot_cross_sections(source)